@@ -0,0 +1,169 @@
+#!/bin/sh
+# Compares the benchmarks against a recorded baseline and fails on
+# regressions.
+#
+# usage: bench/gate.sh [--record] [--timings] [baseline]
+#
+# Runs the end-to-end benchmark on $GATE_SIZES sections (10^4 and 10^5 by
+# default) and the micro-benchmarks, and writes their metrics to
+# $OUT/results.json:
+#   time.<sections>.<phase>  wall time of a phase in seconds
+#   rss.<sections>           peak resident memory in kilobytes
+#   time.micro.<benchmark>   nanoseconds per operation
+#   allocs.micro.<benchmark> allocations per operation
+#   bytes.micro.<benchmark>  allocated bytes per operation
+#
+# A metric regresses, if it exceeds its baseline by more than the relative
+# and the absolute tolerance of the longest matching prefix in the baseline.
+# Only the allocations and bytes fail the gate by default, since they're the
+# same on every machine. Times and memory are printed for information; with
+# --timings they fail the gate as well, which only makes sense on the machine
+# the baseline was recorded on. The exit status is 1 on regressions, 2 if the
+# benchmarks fail.
+#
+# --record replaces the metrics of the baseline (bench/baseline.json) by the
+# current ones and keeps its tolerances.
+
+BENCH=$(cd "$(dirname "$0")" && pwd)
+OUT=${OUT:-$BENCH/out}
+GATE_SIZES=${GATE_SIZES:-10000 100000}
+RECORD=
+TIMINGS=0
+
+while [ $# -gt 0 ]; do
+	case $1 in
+	--record)  RECORD=1 ;;
+	--timings) TIMINGS=1 ;;
+	*)         break ;;
+	esac
+	shift
+done
+
+BASELINE=${1:-$BENCH/baseline.json}
+RESULTS=$OUT/results.json
+
+mkdir -p "$OUT" || exit 2
+
+OUT=$OUT "$BENCH/run.sh" $GATE_SIZES > "$OUT/gate.log" 2>&1 \
+	|| { cat "$OUT/gate.log"; exit 2; }
+"$BENCH/micro" --json --scale 0.25 > "$OUT/micro.json" || exit 2
+
+# one metric per line, so the files stay readable by awk
+{
+	echo '{'
+	echo '"metrics": {'
+
+	for size in $GATE_SIZES; do
+		awk -v size=$size '
+			function value(key) { return (match($0, "\"" key "\":[^,}]*")) \
+				? substr($0, RSTART + length(key) + 3, RLENGTH - length(key) - 3) : "" }
+			/"peakRss"/ { printf "\"rss.%s\": %s,\n", size, value("peakRss") }
+			/"name":/   { n = value("name"); gsub(/"/, "", n)
+			              printf "\"time.%s.%s\": %s,\n", size, n, value("wall") }
+		' "$OUT/$size.json"
+	done
+
+	awk '
+		function value(key) { return (match($0, "\"" key "\":[^,}]*")) \
+			? substr($0, RSTART + length(key) + 3, RLENGTH - length(key) - 3) : "" }
+		/"name":/ { n = value("name"); gsub(/"/, "", n)
+		            printf "\"time.micro.%s\": %s,\n", n, value("nsPerOp")
+		            printf "\"allocs.micro.%s\": %s,\n", n, value("allocsPerOp")
+		            printf "\"bytes.micro.%s\": %s,\n", n, value("bytesPerOp") }
+	' "$OUT/micro.json"
+} | sed '$ s/,$//' > "$RESULTS.tmp"
+
+echo '}' >> "$RESULTS.tmp"
+echo '}' >> "$RESULTS.tmp"
+mv "$RESULTS.tmp" "$RESULTS"
+
+if [ -n "$RECORD" ]; then
+	if [ -f "$BASELINE" ]; then
+		tolerances=$(awk '/^"tolerances"/ { on = 1; next } on && /^}/ { exit } on' \
+			"$BASELINE")
+	else
+		tolerances='"time.": [0.5, 0.02],
+"time.micro.": [0.5, 20],
+"rss.": [0.2, 2048],
+"allocs.": [0.05, 0.01],
+"bytes.": [0.1, 1]'
+	fi
+
+	{
+		echo '{'
+		echo '"tolerances": {'
+		echo "$tolerances"
+		echo '},'
+		sed '1d' "$RESULTS"
+	} > "$BASELINE"
+
+	echo "recorded $BASELINE"
+	exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+	echo "ERROR: baseline $BASELINE doesn't exist, record it using --record"
+	exit 2
+fi
+
+awk -v timings=$TIMINGS '
+	# "key": value or "key": [relative, absolute]
+	function parse() {
+		if (!match($0, /^"[^"]*"/))
+			return 0
+		key = substr($0, 2, RLENGTH - 2)
+		val = substr($0, RLENGTH + 1)
+		gsub(/[:,\[\] ]+/, " ", val)
+		return split(val, parts, " ")
+	}
+
+	FNR == 1 { file++; section = "" }
+	/^"tolerances"/ { section = "tolerances"; next }
+	/^"metrics"/    { section = "metrics"; next }
+
+	section == "tolerances" && parse() == 2 {
+		relative[key] = parts[1]
+		absolute[key] = parts[2]
+	}
+	section == "metrics" && parse() == 1 {
+		if (file == 1) { base[key] = parts[1]; order[++count] = key }
+		else curr[key] = parts[1]
+	}
+
+	END {
+		printf "%-42s %12s %12s %8s  %s\n", "metric", "baseline", "current",
+		       "change", "status"
+		for (i = 1; i <= count; ++i) {
+			k = order[i]
+			best = ""
+			for (t in relative)
+				if (index(k, t) == 1 && length(t) > length(best))
+					best = t
+			rel = (best != "") ? relative[best] : 0
+			abs = (best != "") ? absolute[best] : 0
+			gated = timings || k ~ /^(allocs|bytes)\./
+			checked += gated
+
+			if (!(k in curr)) {
+				printf "%-42s %12s %12s %8s  %s\n", k, base[k], "-", "-", "MISSING"
+				failed++
+				continue
+			}
+
+			change = (base[k] != 0) ? sprintf("%+.1f%%", (curr[k] - base[k]) * 100 / base[k]) : "-"
+			status = "ok"
+
+			if (curr[k] > base[k] * (1 + rel) && curr[k] > base[k] + abs) {
+				status = (gated) ? "REGRESSED" : "worse, not gated"
+				failed += gated
+			}
+			else if (curr[k] < base[k] * (1 - rel) && curr[k] < base[k] - abs)
+				status = "improved"
+
+			printf "%-42s %12s %12s %8s  %s\n", k, base[k], curr[k], change, status
+		}
+
+		printf "\n%d of %d gated metrics regressed\n", failed, checked
+		exit (failed != 0)
+	}
+' "$BASELINE" "$RESULTS"
@@ -0,0 +1,379 @@
+/***************************************************************************//**
+ * @file gen.c
+ * @author Dorian Weber
+ * @brief Generator of synthetic object sets for the benchmarks.
+ *
+ * Writes a directory of files \c o0.o, \c o1.o, ... that contain what
+ * <tt>objdump -rh</tt> prints for a PE object compiled with
+ * <tt>-ffunction-sections -fdata-sections</tt>: the section headers and the
+ * relocation records of every section. The stand-in objdump of the benchmark
+ * just prints them, so deadstrip can be timed without a toolchain.
+ *
+ * Sections are numbered globally and spread evenly over the objects. The
+ * first section is \c .text$main, the seed of the analysis. Every section
+ * references a number of other sections drawn from the fan-out distribution;
+ * most references point to a later section, mostly a close one, the others
+ * to an earlier one, which closes cycles. Some sections are never referenced
+ * and some references go to symbols outside of the set, like library functions.
+ *
+ * Whether a section holds data or is never referenced depends only on its
+ * number, so the whole set is generated in one pass with constant memory.
+ ******************************************************************************/
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/* *************************************************************** structures */
+
+#define SO_MAXNAME  4096  /**<@brief Maximum length of a generated name. */
+
+/**@brief Distributions of the number of references of a section.
+ */
+enum
+{
+	DIST_FIXED, /**< Every section has the mean. */
+	DIST_UNIFORM, /**< Uniform between zero and twice the mean. */
+	DIST_GEOMETRIC, /**< Geometric, like most call graphs. */
+	DIST_POWER /**< Power law, a few sections reference very many. */
+};
+
+/**@brief Parameters of the generated set.
+ */
+typedef struct
+{
+	unsigned long objects; /**< Number of objects. */
+	unsigned long sections; /**< Number of sections per object. */
+	double fanout; /**< Mean number of references per section. */
+	int dist; /**< Distribution of the references. */
+	double cycles; /**< Share of references to earlier sections. */
+	double data; /**< Share of data sections. */
+	double unused; /**< Share of sections that are never referenced. */
+	double external; /**< Share of references to undefined symbols. */
+	unsigned int name; /**< Minimum length of a name. */
+	unsigned long seed; /**< Seed of the random numbers. */
+	const char* dir; /**< Destination directory. */
+} params;
+
+static unsigned long long state; /**<@brief State of the random numbers. */
+
+/* ******************************************************** private functions */
+
+/**@brief Mixes the bits of a number (splitmix64).
+ */
+static unsigned long long mix(unsigned long long x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/**@brief Returns a random number in [0, 1).
+ */
+static double uniform()
+{
+	state += 0x9e3779b97f4a7c15ULL;
+	return (mix(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**@brief Returns a number in [0, 1) that only depends on a section and a
+ * property, so it's the same wherever the section is referenced.
+ */
+static double trait(const params* p, unsigned long section, unsigned int what)
+{
+	return (mix(mix(p->seed ^ section) + what) >> 11)
+	       * (1.0 / 9007199254740992.0);
+}
+
+/**@brief Returns whether a section holds data.
+ */
+static int isData(const params* p, unsigned long section)
+{
+	return section && trait(p, section, 1) < p->data;
+}
+
+/**@brief Returns whether a section is never referenced.
+ */
+static int isUnused(const params* p, unsigned long section)
+{
+	return section && trait(p, section, 2) < p->unused;
+}
+
+/**@brief Writes the name of a section into a buffer.
+ *
+ * Names look like mangled C++ functions, padded with nested namespaces to
+ * the minimum length, e.g. <tt>_ZN5bench6n00000f42Ev</tt>.
+ */
+static const char* name(const params* p, unsigned long section, char* buf)
+{
+	char id[32];
+	size_t len = 0, idLen;
+	unsigned int ns = 0;
+	
+	if (!section)
+		return "main";
+	
+	idLen = (size_t) sprintf(id, "f%lu", section);
+	len += (size_t) sprintf(buf, "_ZN5bench");
+	
+	/* pad with namespaces, reserving space for the identifier */
+	while (len + idLen + 6 < p->name && len + 20 < SO_MAXNAME)
+	{
+		size_t pad = p->name - len - idLen - 6;
+		
+		if (pad > 24)
+			pad = 24;
+		else if (pad < 8)
+			pad = 8;
+		
+		len += (size_t) sprintf(buf + len, "%lu%c%0*u", (unsigned long) pad,
+		                        'n', (int) pad - 1, ns++);
+	}
+	
+	sprintf(buf + len, "%lu%sEv", (unsigned long) idLen, id);
+	return buf;
+}
+
+/**@brief Draws the number of references of a section.
+ */
+static unsigned long fanout(const params* p)
+{
+	double u;
+	
+	switch (p->dist)
+	{
+	case DIST_FIXED:
+		return (unsigned long) p->fanout;
+	case DIST_UNIFORM:
+		return (unsigned long) (uniform() * (2 * p->fanout + 1));
+	case DIST_GEOMETRIC:
+		u = uniform();
+		return (unsigned long) (log(1 - u) / log(p->fanout / (p->fanout + 1)));
+	default:
+		/* Pareto with exponent 2.5, whose mean is thrice the minimum */
+		u = uniform();
+		return (unsigned long) (p->fanout / 3 / pow(1 - u, 1 / 1.5));
+	}
+}
+
+/**@brief Draws a referenced section that is neither the referencing one nor
+ * unused.
+ * @return the section, or the total number of sections for an external one
+ */
+static unsigned long target(const params* p, unsigned long from)
+{
+	unsigned long total = p->objects * p->sections, res;
+	int tries;
+	
+	if (uniform() < p->external)
+		return total;
+	
+	for (tries = 0; tries < 8; ++tries)
+	{
+		/* the distance is log-uniform, so most references stay close */
+		if (from + 1 < total && (!from || uniform() >= p->cycles))
+			res = from + (unsigned long) exp(uniform() * log(total - from));
+		else if (from)
+			res = (unsigned long) (uniform() * from);
+		else
+			break;
+		
+		if (res && !isUnused(p, res))
+			return res;
+	}
+	
+	return total;
+}
+
+/**@brief Writes one object.
+ */
+static int writeObject(const params* p, unsigned long object, FILE* out)
+{
+	static char buf[SO_MAXNAME + 64], ref[SO_MAXNAME + 64];
+	unsigned long first = object * p->sections, i, j, n;
+	unsigned long offset = 0xb4;
+	
+	fprintf(out, "Sections:\n"
+	        "Idx Name          Size      VMA       LMA       File off  Algn\n"
+	        "  0 .text         00000000  00000000  00000000  00000000  2**2\n"
+	        "                  ALLOC, LOAD, READONLY, CODE\n");
+	
+	for (i = 0; i < p->sections; ++i)
+	{
+		unsigned long s = first + i, size = 16 + (unsigned long) (uniform() * 240);
+		
+		fprintf(out, "%3lu .%s$%-8s %08lx  00000000  00000000  %08lx  2**4\n"
+		        "                  CONTENTS, ALLOC, LOAD, RELOC, %s\n", i + 1,
+		        isData(p, s) ? "data" : "text", name(p, s, buf), size, offset,
+		        isData(p, s) ? "DATA" : "READONLY, CODE");
+		offset += size;
+	}
+	
+	for (i = 0; i < p->sections; ++i)
+	{
+		unsigned long s = first + i;
+		
+		/* main calls enough to reach most of the set */
+		if (!(n = fanout(p)) && s)
+			continue;
+		else if (!s && n < 16)
+			n = 16;
+		
+		fprintf(out, "RELOCATION RECORDS FOR [.%s$%s]:\n"
+		        "OFFSET   TYPE              VALUE\n",
+		        isData(p, s) ? "data" : "text", name(p, s, buf));
+		
+		for (j = 0; j < n; ++j)
+		{
+			unsigned long t = target(p, s);
+			
+			if (t == p->objects * p->sections)
+				sprintf(ref, "_ext%lu", (unsigned long) (uniform() * 64));
+			else
+				ref[0] = '_', name(p, t, ref + 1);
+			
+			fprintf(out, "%08lx %-17s %s\n", 4 + j * 5,
+			        isData(p, t) ? "dir32" : "DISP32", ref);
+		}
+		
+		fprintf(out, "\n");
+	}
+	
+	return !ferror(out);
+}
+
+/**@brief Returns the distribution of a name, or -1.
+ */
+static int distribution(const char* src)
+{
+	static const char* names[] = { "fixed", "uniform", "geometric", "power" };
+	int i;
+	
+	for (i = 0; i < 4; ++i)
+		if (!strcmp(src, names[i]))
+			return i;
+	
+	return -1;
+}
+
+/**@brief Prints the usage.
+ */
+static void usage(FILE* out)
+{
+	fprintf(out,
+	        "usage: gen [options] <directory>\n"
+	        "     --objects <n>       number of objects (100)\n"
+	        "     --sections <n>      sections per object (10)\n"
+	        "     --fanout <x>        mean references per section (4)\n"
+	        "     --dist <name>       fixed, uniform, geometric or power\n"
+	        "                         distribution of the references (geometric)\n"
+	        "     --cycles <x>        share of references to earlier sections,\n"
+	        "                         which close cycles (0.05)\n"
+	        "     --data <x>          share of data sections (0.2)\n"
+	        "     --unused <x>        share of unreferenced sections (0.1)\n"
+	        "     --external <x>      share of references to undefined symbols\n"
+	        "                         (0.1)\n"
+	        "     --name <n>          minimum length of a name (16)\n"
+	        "     --seed <n>          seed of the random numbers (1)\n");
+}
+
+/* ******************************************************* exported functions */
+
+int main(int argc, char** argv)
+{
+	params p = { 100, 10, 4, DIST_GEOMETRIC, 0.05, 0.2, 0.1, 0.1, 16, 1, 0 };
+	char path[4096];
+	unsigned long i;
+	int arg;
+	
+	for (arg = 1; arg < argc; ++arg)
+	{
+		const char* opt = argv[arg];
+		const char* val = (arg + 1 < argc) ? argv[arg + 1] : 0;
+		
+		if (*opt != '-')
+		{
+			p.dir = opt;
+			continue;
+		}
+		
+		if (!val)
+		{
+			usage(stderr);
+			return 1;
+		}
+		
+		++arg;
+		
+		if (!strcmp(opt, "--objects"))
+			p.objects = strtoul(val, 0, 10);
+		else if (!strcmp(opt, "--sections"))
+			p.sections = strtoul(val, 0, 10);
+		else if (!strcmp(opt, "--fanout"))
+			p.fanout = atof(val);
+		else if (!strcmp(opt, "--dist"))
+			p.dist = distribution(val);
+		else if (!strcmp(opt, "--cycles"))
+			p.cycles = atof(val);
+		else if (!strcmp(opt, "--data"))
+			p.data = atof(val);
+		else if (!strcmp(opt, "--unused"))
+			p.unused = atof(val);
+		else if (!strcmp(opt, "--external"))
+			p.external = atof(val);
+		else if (!strcmp(opt, "--name"))
+			p.name = (unsigned int) strtoul(val, 0, 10);
+		else if (!strcmp(opt, "--seed"))
+			p.seed = strtoul(val, 0, 10);
+		else
+		{
+			fprintf(stderr, "ERROR: unknown option '%s'\n", opt);
+			usage(stderr);
+			return 1;
+		}
+	}
+	
+	if (!p.dir || !p.objects || !p.sections || p.dist < 0 || p.fanout < 0
+	    || p.name > SO_MAXNAME)
+	{
+		usage(stderr);
+		return 1;
+	}
+	
+	if (mkdir(p.dir, 0777) && errno != EEXIST)
+	{
+		fprintf(stderr, "ERROR: can't create '%s'\n", p.dir);
+		return 1;
+	}
+	
+	state = mix(p.seed);
+	
+	for (i = 0; i < p.objects; ++i)
+	{
+		FILE* out;
+		int ok;
+		
+		sprintf(path, "%.4000s/o%lu.o", p.dir, i);
+		
+		if (!(out = fopen(path, "w")))
+		{
+			fprintf(stderr, "ERROR: can't write '%s'\n", path);
+			return 1;
+		}
+		
+		ok = writeObject(&p, i, out);
+		
+		if (fclose(out) || !ok)
+		{
+			fprintf(stderr, "ERROR: can't write '%s'\n", path);
+			return 1;
+		}
+	}
+	
+	return 0;
+}
@@ -0,0 +1,623 @@
+/***************************************************************************//**
+ * @file micro.c
+ * @author Dorian Weber
+ * @brief Micro-benchmarks of the containers and the coloring.
+ *
+ * Every benchmark measures a number of operations of the hashmap, the list,
+ * the graph or the analysis context and reports the time and the number of
+ * allocations per operation. The allocations are counted by wrapping the
+ * allocator of glibc; with other C libraries they are reported as zero.
+ *
+ * Keys come in two distributions: short C names and mangled C++ names that
+ * share a long prefix, which is what the hashmaps see in C++ projects.
+ *
+ * Every benchmark is repeated and the fastest run gets reported, since the
+ * others only differ by noise.
+ ******************************************************************************/
+
+#include "deadstrip.h"
+#include "graph.h"
+#include "hashmap.h"
+#include "list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* *************************************************************** structures */
+
+/**@brief Key distributions.
+ */
+enum
+{
+	KEYS_SHORT, /**< C names like \c f42. */
+	KEYS_MANGLED /**< Mangled names with a long shared prefix. */
+};
+
+/**@brief Measurement of a benchmark.
+ */
+typedef struct
+{
+	double ns; /**< Elapsed time in nanoseconds. */
+	unsigned long allocs; /**< Number of allocations. */
+	unsigned long bytes; /**< Number of allocated bytes. */
+	unsigned long ops; /**< Number of operations. */
+} result;
+
+/**@brief A benchmark.
+ */
+typedef struct
+{
+	const char* name; /**< Name, as reported and filtered. */
+	void (*run)(unsigned long n, int keys, result* res); /**< Runs it. */
+	unsigned long n; /**< Number of operations at scale 1. */
+	int keys; /**< Key distribution, or -1 if it doesn't use keys. */
+} benchmark;
+
+static unsigned long allocs; /**<@brief Allocations so far. */
+static unsigned long bytes; /**<@brief Allocated bytes so far. */
+static double started; /**<@brief Start of the measurement. */
+static unsigned long startAllocs; /**<@brief Allocations at its start. */
+static unsigned long startBytes; /**<@brief Allocated bytes at its start. */
+static volatile unsigned long sink; /**<@brief Keeps results alive. */
+
+/* ******************************************************* allocation counting */
+
+#ifdef __GLIBC__
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+void* malloc(size_t size)
+{
+	++allocs;
+	bytes += size;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+	++allocs;
+	bytes += count * size;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+	++allocs;
+	bytes += size;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+	__libc_free(ptr);
+}
+#endif
+
+/* ******************************************************** private functions */
+
+/**@brief Returns the monotonic time in nanoseconds.
+ */
+static double now()
+{
+	struct timespec ts;
+	
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**@brief Starts measuring, after the setup of a benchmark.
+ */
+static void start()
+{
+	startAllocs = allocs;
+	startBytes = bytes;
+	started = now();
+}
+
+/**@brief Stops measuring, before the cleanup of a benchmark.
+ */
+static void stop(result* res, unsigned long ops)
+{
+	res->ns = now() - started;
+	res->allocs = allocs - startAllocs;
+	res->bytes = bytes - startBytes;
+	res->ops = ops;
+}
+
+/**@brief Returns a pseudo-random number (xorshift).
+ */
+static unsigned long random32(unsigned long* state)
+{
+	unsigned long x = *state;
+	
+	x ^= (x << 13) & 0xffffffffUL;
+	x ^= x >> 17;
+	x ^= (x << 5) & 0xffffffffUL;
+	
+	return *state = x;
+}
+
+/**@brief Creates the keys of a distribution.
+ * @param[in] n      number of keys
+ * @param[in] keys   distribution
+ * @param[in] first  number of the first key, so key sets can be disjoint
+ */
+static char** newKeys(unsigned long n, int keys, unsigned long first)
+{
+	char** res = (char**) malloc(sizeof(char*) * n);
+	char buf[256];
+	unsigned long i;
+	
+	for (i = 0; i < n; ++i)
+	{
+		unsigned long k = first + i;
+		
+		if (keys == KEYS_SHORT)
+			sprintf(buf, "f%lu", k);
+		else
+			/* nested class templates, the function differs at the end */
+			sprintf(buf, "_ZN5bench6detail14basic_registryINS_11allocatorsI"
+			        "NS_5tokenEEEE%lu%s%luEPKcRKNSt7__cxx1112basic_stringIcSt11"
+			        "char_traitsIcESaIcEEE", (k % 7) + 6, "method", k);
+		
+		res[i] = strdup(buf);
+	}
+	
+	return res;
+}
+
+/**@brief Frees the keys.
+ */
+static void deleteKeys(char** keys, unsigned long n)
+{
+	while (n)
+		free(keys[--n]);
+	
+	free(keys);
+}
+
+/**@brief Shuffles the keys, so lookups don't follow insertion order.
+ */
+static void shuffle(char** keys, unsigned long n)
+{
+	unsigned long state = 2463534242UL, i;
+	
+	for (i = n; i > 1; --i)
+	{
+		unsigned long j = random32(&state) % i;
+		char* tmp = keys[i - 1];
+		
+		keys[i - 1] = keys[j];
+		keys[j] = tmp;
+	}
+}
+
+/**@brief Fills a hashmap with the keys.
+ */
+static hashmap* newFilledMap(char** keys, unsigned long n)
+{
+	hashmap* map = newHashmap(0);
+	unsigned long i;
+	
+	for (i = 0; i < n; ++i)
+		hashmapSet(map, keys[i], keys[i]);
+	
+	return map;
+}
+
+/**@brief Accumulates the visited entries of hashmapProcess().
+ */
+static void visit(const char* key, const void* datum)
+{
+	(void) datum;
+	sink += (unsigned char) *key;
+}
+
+/* ****************************************************************** hashmap */
+
+/**@brief Inserts distinct keys into a growing hashmap.
+ */
+static void benchInsert(unsigned long n, int keys, result* res)
+{
+	char** k = newKeys(n, keys, 0);
+	hashmap* map;
+	unsigned long i;
+	
+	start();
+	map = newHashmap(0);
+	
+	for (i = 0; i < n; ++i)
+		hashmapSet(map, k[i], k[i]);
+	
+	stop(res, n);
+	deleteHashmap(map);
+	deleteKeys(k, n);
+}
+
+/**@brief Looks up present keys in random order.
+ */
+static void benchGet(unsigned long n, int keys, result* res)
+{
+	char** k = newKeys(n, keys, 0);
+	hashmap* map = newFilledMap(k, n);
+	unsigned long i;
+	
+	shuffle(k, n);
+	start();
+	
+	for (i = 0; i < n; ++i)
+		sink += (hashmapGet(map, k[i]) != 0);
+	
+	stop(res, n);
+	deleteHashmap(map);
+	deleteKeys(k, n);
+}
+
+/**@brief Looks up absent keys.
+ */
+static void benchMiss(unsigned long n, int keys, result* res)
+{
+	char** k = newKeys(n, keys, 0);
+	char** absent = newKeys(n, keys, n);
+	hashmap* map = newFilledMap(k, n);
+	unsigned long i;
+	
+	start();
+	
+	for (i = 0; i < n; ++i)
+		sink += (hashmapGet(map, absent[i]) != 0);
+	
+	stop(res, n);
+	deleteHashmap(map);
+	deleteKeys(absent, n);
+	deleteKeys(k, n);
+}
+
+/**@brief Removes and inserts keys in turn, so the table fills with removed
+ * entries, like the analysis of a server that keeps relinking.
+ */
+static void benchChurn(unsigned long n, int keys, result* res)
+{
+	unsigned long live = n / 4, i;
+	char** k = newKeys(n + live, keys, 0);
+	hashmap* map = newFilledMap(k, live);
+	
+	start();
+	
+	/* an operation is one removal and one insertion */
+	for (i = 0; i < n; ++i)
+	{
+		sink += (hashmapRemove(map, k[i]) != 0);
+		hashmapSet(map, k[i + live], k[i + live]);
+	}
+	
+	stop(res, n);
+	deleteHashmap(map);
+	deleteKeys(k, n + live);
+}
+
+/**@brief Visits all entries in sorted order.
+ */
+static void benchProcess(unsigned long n, int keys, result* res)
+{
+	char** k = newKeys(n, keys, 0);
+	hashmap* map = newFilledMap(k, n);
+	
+	start();
+	hashmapProcess(map, visit);
+	stop(res, n);
+	
+	deleteHashmap(map);
+	deleteKeys(k, n);
+}
+
+/* ********************************************************************* list */
+
+/**@brief Appends to a list.
+ */
+static void benchAppend(unsigned long n, int keys, result* res)
+{
+	list* l;
+	unsigned long i;
+	
+	(void) keys;
+	start();
+	l = newList();
+	
+	for (i = 0; i < n; ++i)
+		listAdd(l, (void*) i);
+	
+	stop(res, n);
+	deleteList(l);
+}
+
+/**@brief Scans a list.
+ */
+static void benchScan(unsigned long n, int keys, result* res)
+{
+	list* l = newList();
+	unsigned long i;
+	
+	(void) keys;
+	
+	for (i = 0; i < n; ++i)
+		listAdd(l, (void*) i);
+	
+	start();
+	
+	listStart(l);
+	while (listNext(l))
+		sink += (unsigned long) listGet(l);
+	
+	stop(res, n);
+	deleteList(l);
+}
+
+/* ******************************************************************** graph */
+
+/**@brief Creates nodes.
+ */
+static graph** newNodes(unsigned long n)
+{
+	graph** res = (graph**) malloc(sizeof(graph*) * n);
+	
+	while (n--)
+		res[n] = newGraph("node");
+	
+	return res;
+}
+
+/**@brief Frees the nodes.
+ */
+static void deleteNodes(graph** nodes, unsigned long n)
+{
+	while (n)
+		deleteGraph(nodes[--n]);
+	
+	free(nodes);
+}
+
+/**@brief Connects one node to many others, like a dispatcher.
+ */
+static void benchFanOut(unsigned long n, int keys, result* res)
+{
+	graph** nodes = newNodes(n + 1);
+	unsigned long i;
+	
+	(void) keys;
+	start();
+	
+	for (i = 1; i <= n; ++i)
+		graphConnect(nodes[0], nodes[i]);
+	
+	stop(res, n);
+	deleteNodes(nodes, n + 1);
+}
+
+/**@brief Connects many nodes to one, like calls of a runtime function.
+ */
+static void benchFanIn(unsigned long n, int keys, result* res)
+{
+	graph** nodes = newNodes(n + 1);
+	unsigned long i;
+	
+	(void) keys;
+	start();
+	
+	for (i = 1; i <= n; ++i)
+		graphConnect(nodes[i], nodes[0]);
+	
+	stop(res, n);
+	deleteNodes(nodes, n + 1);
+}
+
+/**@brief Repeats references, like relocations of the same call.
+ */
+static void benchRepeat(unsigned long n, int keys, result* res)
+{
+	graph** nodes = newNodes(17);
+	unsigned long i;
+	
+	(void) keys;
+	start();
+	
+	for (i = 0; i < n; ++i)
+		graphConnect(nodes[0], nodes[1 + i % 16]);
+	
+	stop(res, n);
+	deleteNodes(nodes, 17);
+}
+
+/* ***************************************************************** coloring */
+
+/**@brief Creates an analysis of sections that reference each other.
+ * @param[in] n     number of sections
+ * @param[in] keys  distribution of the section names
+ * @param[in] tree  \c 1 for a binary tree, \c 0 for a chain
+ */
+static deadstrip* newAnalysis(unsigned long n, int keys, int tree)
+{
+	deadstrip* ds = newDeadstrip();
+	char** k = newKeys(n, keys, 0);
+	unsigned long i;
+	
+	for (i = 1; i < n; ++i)
+		deadstripConnect(ds, k[(tree) ? (i - 1) / 2 : i - 1], k[i]);
+	
+	deleteKeys(k, n);
+	return ds;
+}
+
+/**@brief Colors all sections of an analysis, starting at its first section,
+ * or removes their color again.
+ */
+static void colorize(unsigned long n, int keys, result* res, int tree,
+                     int remove)
+{
+	deadstrip* ds = newAnalysis(n, keys, tree);
+	char** k = newKeys(1, keys, 0);
+	
+	if (remove)
+		deadstripColorize(ds, k[0], DEADSTRIP_SEED);
+	
+	start();
+	
+	if (remove)
+		deadstripUncolorize(ds, k[0], DEADSTRIP_SEED);
+	else
+		deadstripColorize(ds, k[0], DEADSTRIP_SEED);
+	
+	stop(res, n);
+	deleteKeys(k, 1);
+	deleteDeadstrip(ds);
+}
+
+/**@brief Colors all sections of a chain.
+ */
+static void benchColorChain(unsigned long n, int keys, result* res)
+{
+	colorize(n, keys, res, 0, 0);
+}
+
+/**@brief Colors all sections of a tree.
+ */
+static void benchColorTree(unsigned long n, int keys, result* res)
+{
+	colorize(n, keys, res, 1, 0);
+}
+
+/**@brief Removes the color of all sections of a chain.
+ */
+static void benchUncolorChain(unsigned long n, int keys, result* res)
+{
+	colorize(n, keys, res, 0, 1);
+}
+
+/**@brief Removes the color of all sections of a tree.
+ */
+static void benchUncolorTree(unsigned long n, int keys, result* res)
+{
+	colorize(n, keys, res, 1, 1);
+}
+
+/**@brief Connects the sections of a chain.
+ */
+static void benchConnect(unsigned long n, int keys, result* res)
+{
+	deadstrip* ds = newDeadstrip();
+	char** k = newKeys(n, keys, 0);
+	unsigned long i;
+	
+	start();
+	
+	for (i = 1; i < n; ++i)
+		deadstripConnect(ds, k[i - 1], k[i]);
+	
+	stop(res, n - 1);
+	deleteKeys(k, n);
+	deleteDeadstrip(ds);
+}
+
+/* ******************************************************* exported functions */
+
+static const benchmark benchmarks[] =
+{
+	{ "hashmap.insert/short", benchInsert, 200000, KEYS_SHORT },
+	{ "hashmap.insert/mangled", benchInsert, 200000, KEYS_MANGLED },
+	{ "hashmap.get/short", benchGet, 200000, KEYS_SHORT },
+	{ "hashmap.get/mangled", benchGet, 200000, KEYS_MANGLED },
+	{ "hashmap.miss/short", benchMiss, 200000, KEYS_SHORT },
+	{ "hashmap.miss/mangled", benchMiss, 200000, KEYS_MANGLED },
+	{ "hashmap.churn/short", benchChurn, 100000, KEYS_SHORT },
+	{ "hashmap.churn/mangled", benchChurn, 100000, KEYS_MANGLED },
+	{ "hashmap.process/short", benchProcess, 200000, KEYS_SHORT },
+	{ "hashmap.process/mangled", benchProcess, 200000, KEYS_MANGLED },
+	{ "list.append", benchAppend, 1000000, -1 },
+	{ "list.scan", benchScan, 1000000, -1 },
+	{ "graph.fanOut", benchFanOut, 10000, -1 },
+	{ "graph.fanIn", benchFanIn, 100000, -1 },
+	{ "graph.repeat", benchRepeat, 1000000, -1 },
+	{ "deadstrip.connect/mangled", benchConnect, 100000, KEYS_MANGLED },
+	{ "deadstrip.colorChain", benchColorChain, 100000, KEYS_SHORT },
+	{ "deadstrip.colorTree", benchColorTree, 100000, KEYS_SHORT },
+	{ "deadstrip.uncolorChain", benchUncolorChain, 100000, KEYS_SHORT },
+	{ "deadstrip.uncolorTree", benchUncolorTree, 100000, KEYS_SHORT }
+};
+
+int main(int argc, char** argv)
+{
+	const unsigned long count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+	const char* filter = 0;
+	double scale = 1;
+	int json = 0, repeat = 3, arg, first = 1;
+	unsigned long i;
+	
+	for (arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--json"))
+			json = 1;
+		else if (!strcmp(argv[arg], "--scale") && arg + 1 < argc)
+			scale = atof(argv[++arg]);
+		else if (!strcmp(argv[arg], "--repeat") && arg + 1 < argc)
+			repeat = atoi(argv[++arg]);
+		else if (*argv[arg] != '-')
+			filter = argv[arg];
+		else
+		{
+			fprintf(stderr, "usage: micro [--json] [--scale <x>] "
+			        "[--repeat <n>] [filter]\n");
+			return 1;
+		}
+	}
+	
+	if (json)
+		printf("{\"benchmarks\":[");
+	else
+		printf("%-26s %9s %12s %12s %12s\n", "benchmark", "ops", "ns/op",
+		       "allocs/op", "bytes/op");
+	
+	for (i = 0; i < count; ++i)
+	{
+		const benchmark* b = benchmarks + i;
+		unsigned long n = (unsigned long) (b->n * scale);
+		result best, res;
+		int r;
+		
+		if (filter && !strstr(b->name, filter))
+			continue;
+		
+		if (n < 2)
+			n = 2;
+		
+		for (r = 0; r < repeat || !r; ++r)
+		{
+			b->run(n, b->keys, &res);
+			
+			if (!r || res.ns < best.ns)
+				best = res;
+		}
+		
+		if (json)
+			printf("%s\n{\"name\":\"%s\",\"ops\":%lu,\"nsPerOp\":%.3f,"
+			       "\"allocsPerOp\":%.3f,\"bytesPerOp\":%.1f}", (first) ? "" : ",",
+			       b->name, best.ops, best.ns / best.ops,
+			       (double) best.allocs / best.ops,
+			       (double) best.bytes / best.ops);
+		else
+			printf("%-26s %9lu %12.1f %12.3f %12.1f\n", b->name, best.ops,
+			       best.ns / best.ops, (double) best.allocs / best.ops,
+			       (double) best.bytes / best.ops);
+		
+		fflush(stdout);
+		first = 0;
+	}
+	
+	if (json)
+		printf("\n]}\n");
+	
+	return 0;
+}
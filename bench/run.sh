@@ -0,0 +1,60 @@
+#!/bin/sh
+# Times the phases of deadstrip on synthetic object sets of growing size.
+#
+# usage: bench/run.sh [sizes...]
+#
+# Every size is a total number of sections, 10^3 to 10^6 by default. The
+# sections are spread over at most 10^4 objects, so the command lines stay
+# short. The stand-ins in bench/bin replace the toolchain, STANDIN_DELAY
+# simulates its latency. The environment tunes the sets and the runs:
+#   GENFLAGS   additional options of the generator, e.g. "--name 300"
+#   DSFLAGS    additional options of deadstrip, e.g. "--dnrm"
+#   OUT        directory of the sets and the results (bench/out)
+#   KEEP       keep the generated sets if non-empty
+# The statistics of every run are kept in $OUT/<size>.json.
+
+BENCH=$(cd "$(dirname "$0")" && pwd)
+DEADSTRIP=$BENCH/../deadstrip
+OUT=${OUT:-$BENCH/out}
+SIZES=${*:-1000 10000 100000 1000000}
+TOOLS="--dumper $BENCH/bin/objdump --remover $BENCH/bin/objcopy --linker $BENCH/bin/ld"
+
+mkdir -p "$OUT" || exit 1
+
+printf '%10s %7s' sections objects
+header=
+
+for size in $SIZES; do
+	objects=$((size / 100))
+	[ $objects -lt 10 ] && objects=10
+	[ $objects -gt 10000 ] && objects=10000
+	sections=$(((size + objects - 1) / objects))
+	set=$OUT/$size
+
+	rm -rf "$set"
+	"$BENCH/gen" --objects $objects --sections $sections $GENFLAGS "$set" \
+		|| exit 1
+
+	(cd "$set" && "$DEADSTRIP" $TOOLS --stats --stats-json "$OUT/$size.json" \
+		$DSFLAGS -o app.exe *.o) > "$OUT/$size.log" 2>&1 \
+		|| { echo; echo "ERROR: deadstrip failed, see $OUT/$size.log"; exit 1; }
+
+	[ -z "$KEEP" ] && rm -rf "$set"
+
+	# one column per phase, then the totals
+	line=$(awk '
+		/<PHASE / { match($0, /name="[^"]*"/); n = substr($0, RSTART + 6, RLENGTH - 7)
+		            match($0, /wall="[^"]*"/); w = substr($0, RSTART + 6, RLENGTH - 7)
+		            names = names sprintf(" %9s", n); times = times sprintf(" %9s", w) }
+		/<STATS / { match($0, /wall="[^"]*"/); total = substr($0, RSTART + 6, RLENGTH - 7)
+		            match($0, /peakRss="[^"]*"/); rss = substr($0, RSTART + 9, RLENGTH - 10) }
+		END { printf "%s %9s %9s\n%s %9s %9s\n", names, "total", "rss[kB]", times, total, rss }
+	' "$OUT/$size.log")
+
+	if [ -z "$header" ]; then
+		header=$(echo "$line" | head -n 1)
+		echo "$header"
+	fi
+
+	printf '%10s %7s%s\n' $((objects * sections)) $objects "$(echo "$line" | tail -n 1)"
+done
@@ -0,0 +1,380 @@
+/***************************************************************************//**
+ * @file stress.c
+ * @author Dorian Weber
+ * @brief Stress test of the analysis on huge graphs of pathological shape.
+ *
+ * Every shape gets built through deadstripConnect() at two sizes, colored
+ * from its first section and uncolored again, and both times the maintained
+ * colors are compared with recomputed ones. The test fails, if they differ,
+ * if the time grows clearly faster than the number of sections and
+ * references, or if the stack usage grows with the size of the graph.
+ *
+ * The shapes are
+ * - \c chain: every section references the next one, which is as deep as a
+ *   graph gets,
+ * - \c star: the first section references all others, like a dispatch table,
+ * - \c funnel: a chain whose sections all reference one more section, like
+ *   calls of a runtime function,
+ * - \c scc: a chain closed to a cycle with additional random references, so
+ *   all sections form one strongly connected component.
+ *
+ * The analysis runs on a thread with a small stack of known size, that's
+ * painted beforehand to measure the usage and protected by a guard page, so
+ * unbounded recursion gets reported instead of corrupting the heap.
+ ******************************************************************************/
+
+#include "deadstrip.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* *************************************************************** structures */
+
+#define SO_PAINT  0xa5  /**<@brief Pattern of the unused stack. */
+
+/**@brief Shapes of the graphs.
+ */
+enum
+{
+	SHAPE_CHAIN, /**< Sections reference the next one. */
+	SHAPE_STAR, /**< The first section references all others. */
+	SHAPE_FUNNEL, /**< A chain, whose sections all reference one more. */
+	SHAPE_SCC, /**< A cycle with additional random references. */
+	SHAPES /**< Number of shapes. */
+};
+
+static const char* shapeNames[SHAPES] = { "chain", "star", "funnel", "scc" };
+
+/**@brief A run of a shape at one size.
+ */
+typedef struct
+{
+	int shape; /**< The shape. */
+	unsigned long sections; /**< Number of sections. */
+	double extra; /**< Additional references per section of an SCC. */
+	double build; /**< Seconds spent connecting the sections. */
+	double color; /**< Seconds spent coloring. */
+	double uncolor; /**< Seconds spent removing the color. */
+	double verify; /**< Seconds spent recomputing the colors. */
+	double teardown; /**< Seconds spent freeing the analysis. */
+	unsigned long edges; /**< Number of distinct references. */
+	size_t stack; /**< Bytes of stack used. */
+	int ok; /**< Whether the colors were right. */
+} run;
+
+static char altStack[1 << 16]; /**<@brief Stack of the signal handler. */
+
+/* ******************************************************** private functions */
+
+/**@brief Reports a stack overflow, which is the only reason for a fault.
+ */
+static void overflow(int sig)
+{
+	static const char msg[] = "\nERROR: stack overflow, the analysis doesn't "
+	                          "run in bounded stack space\n";
+	
+	(void) sig;
+	
+	if (write(2, msg, sizeof(msg) - 1) < 0)
+		_exit(3);
+	
+	_exit(3);
+}
+
+/**@brief Writes the name of a section.
+ */
+static const char* name(char* buf, unsigned long section)
+{
+	sprintf(buf, "s%lu", section);
+	return buf;
+}
+
+/**@brief Returns a pseudo-random number (xorshift).
+ */
+static unsigned long long random64(unsigned long long* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	
+	return *state;
+}
+
+/**@brief Builds, colors and uncolors a graph, running on the small stack.
+ */
+static void* analyze(void* arg)
+{
+	run* r = (run*) arg;
+	deadstrip* ds = newDeadstrip();
+	unsigned long n = r->sections, i;
+	unsigned long long state = 88172645463325252ULL;
+	char src[32], dest[32], first[32], last[32];
+	unsigned long wrong;
+	deadstripCounts counts;
+	stack_t ss;
+	double t;
+	
+	/* faults get handled on a stack of their own */
+	ss.ss_sp = altStack;
+	ss.ss_size = sizeof(altStack);
+	ss.ss_flags = 0;
+	sigaltstack(&ss, 0);
+	
+	name(first, 0);
+	name(last, n - 1);
+	
+	t = statsTime();
+	
+	for (i = 1; i < n; ++i)
+		switch (r->shape)
+		{
+		case SHAPE_STAR:
+			deadstripConnect(ds, first, name(dest, i));
+			break;
+		case SHAPE_FUNNEL:
+			deadstripConnect(ds, name(src, i - 1), name(dest, i));
+			deadstripConnect(ds, src, "hub");
+			break;
+		default:
+			deadstripConnect(ds, name(src, i - 1), name(dest, i));
+			break;
+		}
+	
+	if (r->shape == SHAPE_SCC)
+	{
+		unsigned long extra = (unsigned long) (r->extra * n);
+		
+		deadstripConnect(ds, last, first);
+		
+		for (i = 0; i < extra; ++i)
+		{
+			name(src, (unsigned long) (random64(&state) % n));
+			deadstripConnect(ds, src, name(dest, random64(&state) % n));
+		}
+	}
+	
+	r->build = statsTime() - t;
+	
+	t = statsTime();
+	deadstripColorize(ds, first, DEADSTRIP_SEED);
+	r->color = statsTime() - t;
+	
+	t = statsTime();
+	wrong = deadstripVerify(ds);
+	r->verify = statsTime() - t;
+	
+	t = statsTime();
+	deadstripUncolorize(ds, first, DEADSTRIP_SEED);
+	r->uncolor = statsTime() - t;
+	
+	t = statsTime();
+	wrong += deadstripVerify(ds);
+	r->verify += statsTime() - t;
+	r->ok = !wrong;
+	
+	deadstripGetCounts(ds, &counts);
+	r->edges = counts.edges;
+	
+	t = statsTime();
+	deleteDeadstrip(ds);
+	r->teardown = statsTime() - t;
+	
+	return 0;
+}
+
+/**@brief Runs a shape at one size on a painted, guarded stack.
+ * @return \c 0 if the thread couldn't be started
+ */
+static int measure(run* r, size_t stackSize)
+{
+	size_t page = (size_t) sysconf(_SC_PAGESIZE), used;
+	pthread_attr_t attr;
+	pthread_t thread;
+	unsigned char* mem;
+	int res;
+	
+	stackSize = (stackSize + page - 1) / page * page;
+	mem = (unsigned char*) mmap(0, stackSize + page, PROT_READ | PROT_WRITE,
+	                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	
+	if (mem == MAP_FAILED)
+		return 0;
+	
+	/* the stack grows down into the guard page */
+	mprotect(mem, page, PROT_NONE);
+	memset(mem + page, SO_PAINT, stackSize);
+	
+	pthread_attr_init(&attr);
+	pthread_attr_setstack(&attr, mem + page, stackSize);
+	res = !pthread_create(&thread, &attr, analyze, r);
+	
+	if (res)
+		pthread_join(thread, 0);
+	
+	pthread_attr_destroy(&attr);
+	
+	/* the lowest overwritten byte marks the deepest point */
+	for (used = 0; used < stackSize && mem[page + used] == SO_PAINT; ++used);
+	r->stack = stackSize - used;
+	
+	munmap(mem, stackSize + page);
+	return res;
+}
+
+/**@brief Prints a run.
+ */
+static void print(const run* r)
+{
+	printf("%-7s %10lu %10lu %9.3f %9.3f %9.3f %9.3f %9.3f %9lu %s\n",
+	       shapeNames[r->shape], r->sections, r->edges, r->build, r->color,
+	       r->uncolor, r->verify, r->teardown, (unsigned long) r->stack,
+	       (r->ok) ? "" : "WRONG COLORS");
+	fflush(stdout);
+}
+
+/**@brief Prints the usage.
+ */
+static void usage(FILE* out)
+{
+	fprintf(out,
+	        "usage: stress [options] [shape...]\n"
+	        "     --sections <n>      sections of the larger graphs (1000000)\n"
+	        "     --factor <n>        ratio of the larger to the smaller graphs\n"
+	        "                         (8)\n"
+	        "     --extra <x>         additional references per section of an\n"
+	        "                         scc (4)\n"
+	        "     --stack <n>         kilobytes of stack for the analysis (256)\n"
+	        "     --exponent <x>      maximal exponent of the growth of the\n"
+	        "                         time (1.25)\n"
+	        "     shapes are chain, star, funnel and scc, all by default\n");
+}
+
+/* ******************************************************* exported functions */
+
+int main(int argc, char** argv)
+{
+	unsigned long sections = 1000000, factor = 8;
+	double extra = 4, exponent = 1.25;
+	size_t stack = 256 << 10;
+	int shapes[SHAPES], count = 0, failed = 0, arg, i;
+	struct sigaction sa;
+	
+	for (arg = 1; arg < argc; ++arg)
+	{
+		const char* opt = argv[arg];
+		
+		if (*opt != '-')
+		{
+			for (i = 0; i < SHAPES && strcmp(opt, shapeNames[i]); ++i);
+			
+			if (i == SHAPES || count == SHAPES)
+			{
+				fprintf(stderr, "ERROR: unknown shape '%s'\n", opt);
+				return 2;
+			}
+			
+			shapes[count++] = i;
+			continue;
+		}
+		
+		if (arg + 1 == argc)
+		{
+			usage(stderr);
+			return 2;
+		}
+		
+		if (!strcmp(opt, "--sections"))
+			sections = strtoul(argv[++arg], 0, 10);
+		else if (!strcmp(opt, "--factor"))
+			factor = strtoul(argv[++arg], 0, 10);
+		else if (!strcmp(opt, "--extra"))
+			extra = atof(argv[++arg]);
+		else if (!strcmp(opt, "--stack"))
+			stack = (size_t) strtoul(argv[++arg], 0, 10) << 10;
+		else if (!strcmp(opt, "--exponent"))
+			exponent = atof(argv[++arg]);
+		else
+		{
+			usage(stderr);
+			return 2;
+		}
+	}
+	
+	if (factor < 2 || sections / factor < 2)
+	{
+		usage(stderr);
+		return 2;
+	}
+	
+	if (!count)
+		for (count = 0; count < SHAPES; ++count)
+			shapes[count] = count;
+	
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = overflow;
+	sa.sa_flags = SA_ONSTACK;
+	sigaction(SIGSEGV, &sa, 0);
+	
+	printf("%-7s %10s %10s %9s %9s %9s %9s %9s %9s\n", "shape", "sections",
+	       "edges", "build", "color", "uncolor", "verify", "teardown",
+	       "stack[B]");
+	
+	for (i = 0; i < count; ++i)
+	{
+		run small, large;
+		double ts, tl;
+		
+		memset(&small, 0, sizeof(run));
+		small.shape = shapes[i];
+		small.sections = sections / factor;
+		small.extra = extra;
+		large = small;
+		large.sections = sections;
+		
+		if (!measure(&small, stack) || !measure(&large, stack))
+		{
+			fprintf(stderr, "ERROR: can't start the analysis thread\n");
+			return 2;
+		}
+		
+		print(&small);
+		print(&large);
+		
+		/* work per section and reference should stay about the same */
+		ts = small.build + small.color + small.uncolor + small.verify
+		     + small.teardown;
+		tl = large.build + large.color + large.uncolor + large.verify
+		     + large.teardown;
+		
+		if (!small.ok || !large.ok)
+			++failed;
+		
+		if (large.stack > small.stack + 4096)
+		{
+			printf("        stack usage grows from %lu to %lu bytes\n",
+			       (unsigned long) small.stack, (unsigned long) large.stack);
+			++failed;
+		}
+		
+		/* too short times are mostly noise */
+		if (ts >= 0.05)
+		{
+			double e = log(tl / ts)
+			           / log((double) (large.sections + large.edges)
+			                 / (small.sections + small.edges));
+			
+			printf("        time grows with exponent %.2f%s\n", e,
+			       (e > exponent) ? ", too fast" : "");
+			failed += (e > exponent);
+		}
+	}
+	
+	printf("\n%d of %d shapes failed\n", failed, count);
+	return failed != 0;
+}
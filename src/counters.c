@@ -0,0 +1,123 @@
+/***************************************************************************//**
+ * @file counters.c
+ * @author Dorian Weber
+ * @brief Implementation of the data structure counters.
+ ******************************************************************************/
+
+#include "counters.h"
+#include "stats.h"
+
+/* *************************************************************** structures */
+
+#define SO_BUCKETS  (sizeof(unsigned long) * 8 + 1) /**<@brief Buckets of a
+                                                          histogram. */
+
+/**@brief Values recorded in a histogram.
+ */
+typedef struct
+{
+	unsigned long count; /**< Number of values. */
+	unsigned long sum; /**< Sum of the values. */
+	unsigned long max; /**< Largest value. */
+	unsigned long buckets[SO_BUCKETS]; /**< Values below successive powers of
+	                                        two, starting at zero. */
+} histogram;
+
+static const char* scalarNames[COUNTERS_SCALARS] =
+	{ "hashmap.rehashes", "hashmap.rehashTime", "hashmap.tombstones",
+	  "hashmap.tombstonesReused", "hashmap.tombstoneRatio",
+	  "colorize.maxDepth" };
+
+static const char* histogramNames[COUNTERS_HISTOGRAMS] =
+	{ "hashmap.probes", "graphConnect.walk" };
+
+static unsigned long scalars[COUNTERS_SCALARS];
+static histogram histograms[COUNTERS_HISTOGRAMS];
+
+/* ******************************************************** private functions */
+
+/**@brief Raises a value atomically.
+ */
+static void atLeast(unsigned long* dest, unsigned long value)
+{
+	unsigned long curr = __atomic_load_n(dest, __ATOMIC_RELAXED);
+	
+	while (curr < value && !__atomic_compare_exchange_n(dest, &curr, value, 1,
+	       __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/**@brief Returns the bucket of a value, i.e. the number of its bits.
+ */
+static unsigned int bucket(unsigned long value)
+{
+	unsigned int res = 0;
+	
+	while (value)
+	{
+		value >>= 1;
+		++res;
+	}
+	
+	return res;
+}
+
+/* ******************************************************* exported functions */
+
+void countersAdd(int counter, unsigned long value)
+{
+	__atomic_fetch_add(scalars + counter, value, __ATOMIC_RELAXED);
+}
+
+void countersMax(int counter, unsigned long value)
+{
+	atLeast(scalars + counter, value);
+}
+
+void countersRecord(int index, unsigned long value)
+{
+	histogram* h = histograms + index;
+	
+	__atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->sum, value, __ATOMIC_RELAXED);
+	__atomic_fetch_add(h->buckets + bucket(value), 1, __ATOMIC_RELAXED);
+	atLeast(&h->max, value);
+}
+
+unsigned long countersClock()
+{
+	return (unsigned long) (statsTime() * 1e6);
+}
+
+void countersDump(FILE* out)
+{
+	unsigned int i, j;
+	
+	fprintf(out, "\n<COUNTERS>\n");
+	
+	for (i = 0; i < COUNTERS_HISTOGRAMS; ++i)
+	{
+		const histogram* h = histograms + i;
+		
+		fprintf(out, "\t<HISTOGRAM name=\"%s\" count=\"%lu\" sum=\"%lu\" "
+		        "max=\"%lu\">\n", histogramNames[i], h->count, h->sum, h->max);
+		
+		/* a bucket holds the values up to the next power of two minus one */
+		for (j = 0; j < SO_BUCKETS; ++j)
+			if (h->buckets[j])
+				fprintf(out, "\t\t<BUCKET max=\"%lu\">%lu</BUCKET>\n",
+				        (j) ? (2UL << (j - 1)) - 1 : 0UL, h->buckets[j]);
+		
+		fprintf(out, "\t</HISTOGRAM>\n");
+	}
+	
+	for (i = 0; i < COUNTERS_SCALARS; ++i)
+		fprintf(out, "\t<COUNT name=\"%s\">%lu</COUNT>\n", scalarNames[i],
+		        scalars[i]);
+	
+	fprintf(out, "</COUNTERS>\n");
+}
+
+void countersReport()
+{
+	countersDump(stderr);
+}
@@ -0,0 +1,92 @@
+/***************************************************************************//**
+ * @file counters.h
+ * @author Dorian Weber
+ * @brief Interface of the data structure counters.
+ *
+ * The counters measure the hot paths of the hashmap, the graph and the
+ * traversals, e.g. the number of probes per lookup. They are only recorded
+ * in a build with \c DEADSTRIP_COUNTERS defined (<tt>make counters</tt>),
+ * otherwise the macros expand to nothing. All counters are global and
+ * updated atomically, since lookups happen in worker threads, too.
+ *
+ * Histograms sort their values into buckets by powers of two.
+ *
+ * @sa counters.c
+ ******************************************************************************/
+
+#ifndef COUNTERS_H_INCLUDED
+#define COUNTERS_H_INCLUDED
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@brief Scalar counters.
+ */
+enum
+{
+	COUNTERS_REHASHES, /**< Number of times a hashmap grew. */
+	COUNTERS_REHASH_TIME, /**< Microseconds spent growing hashmaps. */
+	COUNTERS_TOMBSTONES, /**< Number of entries removed from hashmaps. */
+	COUNTERS_TOMBSTONES_REUSED, /**< Number of insertions into removed
+	                                 entries. */
+	COUNTERS_TOMBSTONE_RATIO, /**< Maximal share of removed entries in a
+	                               grown or deleted hashmap, in permille. */
+	COUNTERS_COLORIZE_DEPTH, /**< Maximal size of the work stack while
+	                              coloring. */
+	COUNTERS_SCALARS /**< Number of scalar counters. */
+};
+
+/**@brief Histograms.
+ */
+enum
+{
+	COUNTERS_PROBES, /**< Slots visited per hashmap lookup. */
+	COUNTERS_CONNECT_WALK, /**< Edges walked per graphConnect(). */
+	COUNTERS_HISTOGRAMS /**< Number of histograms. */
+};
+
+/**@brief Adds a value to a scalar counter.
+ */
+extern void countersAdd(int counter, unsigned long value);
+
+/**@brief Raises a scalar counter to a value, if it's lower.
+ */
+extern void countersMax(int counter, unsigned long value);
+
+/**@brief Records a value in a histogram.
+ */
+extern void countersRecord(int histogram, unsigned long value);
+
+/**@brief Returns the current wall time in microseconds.
+ */
+extern unsigned long countersClock();
+
+/**@brief Dumps all counters in XML-like format.
+ */
+extern void countersDump(FILE* out);
+
+/**@brief Dumps all counters to \c stderr, meant to be passed to atexit().
+ */
+extern void countersReport();
+
+#ifdef DEADSTRIP_COUNTERS
+#define COUNTERS_ADD(counter, value)        countersAdd(counter, value)
+#define COUNTERS_MAX(counter, value)        countersMax(counter, value)
+#define COUNTERS_RECORD(histogram, value)   countersRecord(histogram, value)
+#define COUNTERS_CLOCK()                    countersClock()
+#else
+/* the values count as used, but aren't evaluated */
+#define COUNTERS_ADD(counter, value)        ((void) sizeof(value))
+#define COUNTERS_MAX(counter, value)        ((void) sizeof(value))
+#define COUNTERS_RECORD(histogram, value)   ((void) sizeof(value))
+#define COUNTERS_CLOCK()                    0UL
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,2796 @@
+/***************************************************************************//**
+ * @file deadstrip.c
+ * @author Dorian Weber
+ * @brief Implementation of the dependency analysis library.
+ ******************************************************************************/
+
+#include "deadstrip.h"
+#include "counters.h"
+#include "depmap.h"
+#include "hashmap.h"
+#include "graph.h"
+#include "parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+/* *************************************************************** structures */
+
+#define SO_WEAK_COUNT  (sizeof(weak)/sizeof(char*))
+
+static const char* weak[] =
+	{ ".rdata" };
+
+#define SO_FUNCTION  ".text$"  /**<@brief Prefix of function sections. */
+#define SO_UNKNOWN   "<unknown>" /**<@brief Source of replayed unknown references. */
+#define SO_BATCH     1024      /**<@brief Objects formatted at once. */
+#define SO_BUFFER    (1 << 20) /**<@brief Size of the output buffer. */
+#define SO_CLUSTER   4096      /**<@brief Size limit of merged clusters. */
+
+/**@brief Analysis data of a section, associated with its graph node.
+ */
+typedef struct s_section
+{
+	char* key; /**< Key of the section. */
+	graph* node; /**< Node in the dependency graph. */
+	unsigned long seed; /**< Colors of the seeds that name the section. */
+	unsigned int decl; /**< Number of objects that declare the section. */
+	unsigned int roots; /**< Number of references from unknown sections. */
+	int mark; /**< Temporary flag used during traversals. */
+	struct s_section* via; /**< Next section on the way to the searched one. */
+	struct s_section* idom; /**< Immediate dominator, \c NULL for roots. */
+	unsigned long size; /**< Size of all declarations in bytes. */
+	unsigned long retained; /**< Size of the dominated sections in bytes. */
+	size_t order; /**< Preorder number during the dominator computation. */
+	unsigned long samples; /**< Number of profile samples. */
+	struct s_section* fold; /**< Identical section that replaces this one. */
+} section;
+
+/**@brief Growable stack of graph nodes.
+ */
+typedef struct
+{
+	graph** data; /**< Array of nodes. */
+	size_t count, /**< Number of nodes on the stack. */
+	       size; /**< Capacity of the array. */
+} nodeStack;
+
+/**@brief Growable text, either zero terminated strings or formatted output.
+ */
+typedef struct
+{
+	char* data; /**< Concatenated text. */
+	size_t count, /**< Used bytes. */
+	       size; /**< Capacity of the buffer. */
+} textBuffer;
+
+/**@brief State of a single analysis.
+ */
+struct s_deadstrip
+{
+	hashmap* sectionMap; /**< Maps section keys to their records. */
+	hashmap* objectMap; /**< Maps file names to their object files. */
+	list* objects; /**< List of object files. */
+	list* sections; /**< List of all section records. */
+	list* seeds; /**< Sections that are named as seeds. */
+	list* suspects; /**< Sections that may have lost some of their colors. */
+	nodeStack stack; /**< Work stack of the traversals. */
+	nodeStack region; /**< Nodes affected by a removal. */
+	textBuffer usage; /**< Flags of the used sections of classified objects. */
+	hashmap* usageMap; /**< Maps file names to their first flag, 1-based,
+	                        \c NULL if the flags are outdated. */
+	int threads; /**< Number of threads used for reports. */
+	stats* stats; /**< Statistics of the current run, may be \c NULL. */
+};
+
+/**@brief Removed and kept bytes of a group of sections.
+ */
+typedef struct
+{
+	const char* name; /**< Name of the group, not terminated for kinds. */
+	int len; /**< Length of the name. */
+	unsigned long removed; /**< Bytes of unused sections. */
+	unsigned long kept; /**< Bytes of used sections. */
+	unsigned long removedPadded; /**< Bytes of unused sections, aligned. */
+	unsigned long keptPadded; /**< Bytes of used sections, aligned. */
+} savings;
+
+/**@brief Value used to sort positions.
+ */
+typedef struct
+{
+	double value; /**< Sort key. */
+	size_t index; /**< Position. */
+} rank;
+
+/**@brief Work shared by the threads that classify or format objects.
+ */
+typedef struct
+{
+	deadstrip* ctx; /**< Analysis context. */
+	objectFile** objects; /**< All objects in link order. */
+	size_t first; /**< Index of the first object of the batch. */
+	textBuffer* parts; /**< Formatted text of every object in the batch. */
+	char* pending; /**< Flags the objects that still have to be classified. */
+	int used; /**< Set, if the used sections are formatted. */
+} objectJob;
+
+/* ******************************************************** private functions */
+
+/**@brief Drops the flags of the used sections after colors, folds or
+ * objects changed.
+ */
+static void invalidate(deadstrip* ctx)
+{
+	if (!ctx->usageMap)
+		return;
+	
+	deleteHashmap(ctx->usageMap);
+	ctx->usageMap = 0;
+	ctx->usage.count = 0;
+}
+
+/**@brief Pushes a node onto a stack.
+ */
+static void push(nodeStack* stack, graph* node)
+{
+	if (stack->count == stack->size)
+	{
+		stack->size = (stack->size) ? stack->size << 1 : 64;
+		stack->data = (graph**) realloc(stack->data, sizeof(graph*) * stack->size);
+	}
+	
+	stack->data[stack->count++] = node;
+}
+
+/**@brief Returns the colors a section has as a root of the graph.
+ */
+static unsigned long rootColor(const section* sec)
+{
+	return sec->seed | ((sec->roots) ? DEADSTRIP_UNKNOWN : 0);
+}
+
+/**@brief Creates the record and graph node of a section.
+ * @param[in] ctx   analysis context
+ * @param[in] key   key of the section
+ * @param[in] name  name of the graph node
+ */
+static section* newSection(deadstrip* ctx, const char* key, const char* name)
+{
+	section* sec = (section*) malloc(sizeof(section));
+	
+	sec->key = strdup(key);
+	sec->node = newGraph(name);
+	sec->seed = 0;
+	sec->decl = 0;
+	sec->roots = 0;
+	sec->mark = 0;
+	sec->via = 0;
+	sec->idom = 0;
+	sec->size = 0;
+	sec->retained = 0;
+	sec->order = 0;
+	sec->samples = 0;
+	sec->fold = 0;
+	
+	graphSetDatum(sec->node, sec);
+	hashmapSet(ctx->sectionMap, sec, key);
+	listAdd(ctx->sections, sec);
+	
+	return sec;
+}
+
+/**@brief Returns the record of a section and creates an undeclared one, if
+ * the key isn't known yet.
+ * @note Undeclared sections keep references to symbols that live outside of
+ * the analyzed objects or that will be declared later on.
+ */
+static section* lookup(deadstrip* ctx, const char* key)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	return (sec) ? sec : newSection(ctx, key, key);
+}
+
+/**@brief Colorizes a graph starting from a given seed.
+ * @param[in] ctx    analysis context
+ * @param[in] seed   initial node
+ * @param[in] color  the color
+ */
+static void colorizeGraph(deadstrip* ctx, graph* seed, unsigned long color)
+{
+	invalidate(ctx);
+	push(&ctx->stack, seed);
+	
+	while (ctx->stack.count)
+	{
+		graph* node = ctx->stack.data[--ctx->stack.count];
+		unsigned long c = graphGetColorNode(node);
+		
+		if ((c | color) != c)
+		{
+			list* depends = graphGetConnections(node);
+			graphColorNode(node, c | color);
+			
+			listStart(depends);
+			while (listNext(depends))
+			{
+				graph* d = (graph*) listGet(depends);
+				
+				if ((graphGetColorNode(d) | color) != graphGetColorNode(d))
+					push(&ctx->stack, d);
+			}
+			
+			COUNTERS_MAX(COUNTERS_COLORIZE_DEPTH, ctx->stack.count);
+		}
+	}
+}
+
+/**@brief Removes the colors that the suspected sections and their dependencies
+ * aren't entitled to anymore.
+ * 
+ * For every color, all nodes reachable from the suspects that carry it, lose
+ * it. Those that still have a root or a predecessor of that color afterwards
+ * get colorized again.
+ * 
+ * @param[in] ctx  analysis context
+ */
+static void uncolorize(deadstrip* ctx)
+{
+	unsigned long colors = 0, color;
+	size_t i;
+	
+	listStart(ctx->suspects);
+	while (listNext(ctx->suspects))
+		colors |= graphGetColorNode(((section*) listGet(ctx->suspects))->node);
+	
+	if (colors)
+		invalidate(ctx);
+	
+	for (color = 1; colors; color <<= 1)
+	{
+		if (!(colors & color))
+			continue;
+		colors &= ~color;
+		
+		
+		/* mark the affected region */
+		listStart(ctx->suspects);
+		while (listNext(ctx->suspects))
+			push(&ctx->stack, ((section*) listGet(ctx->suspects))->node);
+		
+		while (ctx->stack.count)
+		{
+			graph* node = ctx->stack.data[--ctx->stack.count];
+			section* sec = (section*) graphGetDatum(node);
+			list* depends;
+			
+			if (sec->mark || !(graphGetColorNode(node) & color))
+				continue;
+			
+			sec->mark = 1;
+			push(&ctx->region, node);
+			
+			depends = graphGetConnections(node);
+			listStart(depends);
+			while (listNext(depends))
+				push(&ctx->stack, (graph*) listGet(depends));
+		}
+		
+		for (i = 0; i < ctx->region.count; ++i)
+		{
+			graph* node = ctx->region.data[i];
+			graphColorNode(node, graphGetColorNode(node) & ~color);
+		}
+		
+		
+		/* colorize again what is still reachable */
+		for (i = 0; i < ctx->region.count; ++i)
+		{
+			graph* node = ctx->region.data[i];
+			section* sec = (section*) graphGetDatum(node);
+			int reachable = (rootColor(sec) & color) != 0;
+			list* pred = graphGetPredecessors(node);
+			
+			listStart(pred);
+			while (!reachable && listNext(pred))
+				reachable = (graphGetColorNode((graph*) listGet(pred)) & color) != 0;
+			
+			if (reachable)
+				colorizeGraph(ctx, node, color);
+		}
+		
+		for (i = 0; i < ctx->region.count; ++i)
+			((section*) graphGetDatum(ctx->region.data[i]))->mark = 0;
+		
+		ctx->region.count = 0;
+	}
+	
+	deleteList(ctx->suspects);
+	ctx->suspects = newList();
+}
+
+/**@brief Adds or removes a reference between two sections.
+ * @param[in] ctx   analysis context
+ * @param[in] src   referencing section, \c NULL for an unknown section
+ * @param[in] dest  referenced section
+ * @param[in] add   \c 1 to add the reference, \c 0 to remove it
+ */
+static void reference(deadstrip* ctx, section* src, section* dest, int add)
+{
+	if (src)
+	{
+		if (add)
+		{
+			/* a new edge only pushes the colors of its source forward */
+			if (graphConnect(src->node, dest->node) == 1
+			    && graphGetColorNode(src->node))
+				colorizeGraph(ctx, dest->node, graphGetColorNode(src->node));
+		}
+		else if (!graphDisconnect(src->node, dest->node))
+			listAdd(ctx->suspects, dest);
+	}
+	
+	/* dependency with unknown section spotted; we need to calculate its
+	 * dependencies as well, because this section will survive for sure
+	 */
+	else if (add)
+	{
+		if (!dest->roots++)
+			colorizeGraph(ctx, dest->node, DEADSTRIP_UNKNOWN);
+	}
+	else if (dest->roots && !--dest->roots)
+		listAdd(ctx->suspects, dest);
+}
+
+/**@brief Declares the sections of an object or withdraws them again.
+ * @param[in] ctx  analysis context
+ * @param[in] obj  object file
+ * @param[in] add  \c 1 to declare the sections, \c 0 to withdraw them
+ */
+static void declare(deadstrip* ctx, objectFile* obj, int add)
+{
+	list* sects = objectFileGetSections(obj);
+	list* sizes = objectFileGetSizes(obj);
+	
+	/* insert all functions and data */
+	listStart(sects);
+	listStart(sizes);
+	while (listNext(sects))
+	{
+		const char* token = (const char*) listGet(sects);
+		unsigned long size;
+		
+		/* the prefix is skipped for key generation
+		 (needed when reading the relocation table) */
+		section* sec = lookup(ctx, objectFileKey(token));
+		
+		listNext(sizes);
+		size = (unsigned long) listGet(sizes);
+		
+		if (add)
+		{
+			/* the first declaration names the node */
+			if (!sec->decl++)
+				graphSetNameNode(sec->node, token);
+			
+			sec->size += size;
+		}
+		else
+		{
+			--sec->decl;
+			sec->size -= size;
+		}
+	}
+}
+
+/**@brief Adds the relocations of an object to the graph or removes them again.
+ * @param[in] ctx  analysis context
+ * @param[in] obj  object file
+ * @param[in] add  \c 1 to add the relocations, \c 0 to remove them
+ */
+static void relocate(deadstrip* ctx, objectFile* obj, int add)
+{
+	list* tables = objectFileGetTables(obj);
+	list* sects = objectFileGetSections(obj);
+	
+	/* connect the sections according to the relocation tables */
+	listStart(tables);
+	while (listNext(tables))
+	{
+		objectFileTable* table = (objectFileTable*) listGet(tables);
+		section* src = (section*) hashmapGet(ctx->sectionMap, table->section);
+		
+		if (src && !src->decl)
+			src = 0;
+		
+		if (!src)
+		{
+			/* test for weak sections */
+			int i = SO_WEAK_COUNT;
+			
+			while (i--)
+				if (!strcmp(table->section, weak[i]))
+					break;
+			
+			/* debug information refers to everything, but keeps nothing */
+			if (i >= 0 || objectFileIsDebug(table->section))
+				continue;
+		}
+		
+		listStart(table->targets);
+		while (listNext(table->targets))
+			reference(ctx, src, lookup(ctx, (const char*) listGet(table->targets)),
+			          add);
+	}
+	
+	/* associated sections are only needed together with their parent */
+	listStart(sects);
+	while (listNext(sects))
+	{
+		const char* name = (const char*) listGet(sects);
+		const char* parent = objectFileParent(name);
+		
+		if (parent)
+			reference(ctx, lookup(ctx, parent), lookup(ctx, name), add);
+	}
+}
+
+/**@brief Adds a batch of objects to the graph or removes them again.
+ * @note All sections are declared before any relocation gets resolved and
+ * withdrawn after all of them got removed, so both directions agree on the
+ * source of each reference.
+ * @param[in] ctx      analysis context
+ * @param[in] objects  list of object files
+ * @param[in] add      \c 1 to add the objects, \c 0 to remove them
+ */
+static void contribute(deadstrip* ctx, list* objects, int add)
+{
+	invalidate(ctx);
+	
+	if (add)
+	{
+		listStart(objects);
+		while (listNext(objects))
+			declare(ctx, (objectFile*) listGet(objects), 1);
+	}
+	
+	listStart(objects);
+	while (listNext(objects))
+		relocate(ctx, (objectFile*) listGet(objects), add);
+	
+	if (!add)
+	{
+		listStart(objects);
+		while (listNext(objects))
+			declare(ctx, (objectFile*) listGet(objects), 0);
+	}
+}
+
+/**@brief Adds or removes a color of a seed.
+ */
+static void plant(deadstrip* ctx, section* sec, unsigned long color, int add)
+{
+	if (add)
+	{
+		if (!sec->seed)
+			listAdd(ctx->seeds, sec);
+		
+		sec->seed |= color;
+		colorizeGraph(ctx, sec->node, color);
+	}
+	else if (sec->seed & color)
+	{
+		sec->seed &= ~color;
+		listAdd(ctx->suspects, sec);
+		
+		if (!sec->seed)
+		{
+			listStart(ctx->seeds);
+			while (listNext(ctx->seeds))
+				if (listGet(ctx->seeds) == sec)
+				{
+					listRemove(ctx->seeds);
+					break;
+				}
+		}
+	}
+}
+
+/**@brief Returns the graph node of a collected section.
+ */
+static graph* getNode(deadstrip* ctx, const char* name)
+{
+	return ((section*) hashmapGet(ctx->sectionMap, objectFileKey(name)))->node;
+}
+
+/**@brief Returns the label with the minimal semidominator on the path from a
+ * vertex to the root of its tree in the forest, compressing that path.
+ * @note The path is compressed iteratively, since it may span the whole graph.
+ * @param[in] v         preorder number of the vertex
+ * @param[in] ancestor  ancestors in the forest, \c 0 for tree roots
+ * @param[in] label     vertex with minimal semidominator on the compressed path
+ * @param[in] semi      semidominators
+ * @param[in] path      scratch space for the path
+ */
+static size_t eval(size_t v, size_t* ancestor, size_t* label,
+                   const size_t* semi, size_t* path)
+{
+	size_t count = 0, u = v;
+	
+	if (!ancestor[v])
+		return v;
+	
+	while (ancestor[ancestor[u]])
+	{
+		path[count++] = u;
+		u = ancestor[u];
+	}
+	
+	/* compress starting with the vertex next to the root */
+	while (count--)
+	{
+		size_t w = path[count];
+		
+		if (semi[label[ancestor[w]]] < semi[label[w]])
+			label[w] = label[ancestor[w]];
+		ancestor[w] = ancestor[ancestor[w]];
+	}
+	
+	return label[v];
+}
+
+/**@brief Pushes a node onto the stack of the depth first search together
+ * with the preorder number of the node that pushes it.
+ */
+static void pushFrom(deadstrip* ctx, graph* node, size_t v, size_t** from,
+                     size_t* size)
+{
+	push(&ctx->stack, node);
+	
+	if (*size < ctx->stack.size)
+	{
+		*size = ctx->stack.size;
+		*from = (size_t*) realloc(*from, sizeof(size_t) * *size);
+	}
+	
+	(*from)[ctx->stack.count - 1] = v;
+}
+
+/**@brief Computes the dominator tree of the used sections and the sizes that
+ * every section retains.
+ *
+ * The tree is rooted in a virtual section that references all seeds and all
+ * sections that are referenced by unknown ones. The dominators are computed
+ * using the algorithm of Lengauer and Tarjan with path compression, all
+ * traversals are iterative.
+ *
+ * @param[in] ctx  analysis context
+ */
+static void dominate(deadstrip* ctx)
+{
+	size_t n = listCount(ctx->sections) + 2, count = 1, i;
+	section** vertex = (section**) malloc(sizeof(section*) * n);
+	size_t* parent = (size_t*) malloc(sizeof(size_t) * n);
+	size_t* semi = (size_t*) malloc(sizeof(size_t) * n);
+	size_t* idom = (size_t*) malloc(sizeof(size_t) * n);
+	size_t* ancestor = (size_t*) calloc(n, sizeof(size_t));
+	size_t* label = (size_t*) malloc(sizeof(size_t) * n);
+	size_t* bucket = (size_t*) calloc(n, sizeof(size_t));
+	size_t* next = (size_t*) malloc(sizeof(size_t) * n);
+	size_t* path = (size_t*) malloc(sizeof(size_t) * n);
+	size_t *from = 0, fromSize = 0;
+	
+	
+	/* depth first search from the virtual root (1), the stack holds the node
+	 together with the preorder number of the one that pushed it */
+	vertex[1] = 0;
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+	{
+		section* sec = (section*) listGet(ctx->sections);
+		
+		sec->idom = 0;
+		sec->retained = 0;
+		
+		if (rootColor(sec))
+			pushFrom(ctx, sec->node, 1, &from, &fromSize);
+	}
+	
+	while (ctx->stack.count)
+	{
+		graph* node = ctx->stack.data[--ctx->stack.count];
+		section* sec = (section*) graphGetDatum(node);
+		size_t v = from[ctx->stack.count];
+		list* depends;
+		
+		if (sec->order)
+			continue;
+		
+		sec->order = ++count;
+		vertex[count] = sec;
+		parent[count] = v;
+		
+		depends = graphGetConnections(node);
+		listStart(depends);
+		while (listNext(depends))
+		{
+			graph* d = (graph*) listGet(depends);
+			
+			if (!((section*) graphGetDatum(d))->order)
+				pushFrom(ctx, d, count, &from, &fromSize);
+		}
+	}
+	
+	for (i = 1; i <= count; ++i)
+	{
+		semi[i] = label[i] = i;
+		idom[i] = 0;
+	}
+	
+	
+	/* semidominators in reverse preorder, implicit dominators via buckets */
+	for (i = count; i > 1; --i)
+	{
+		section* w = vertex[i];
+		list* pred = graphGetPredecessors(w->node);
+		size_t p = parent[i], v;
+		
+		if (rootColor(w))
+			semi[i] = 1;
+		
+		listStart(pred);
+		while (listNext(pred))
+		{
+			size_t o = ((section*) graphGetDatum((graph*) listGet(pred)))->order;
+			
+			if (o)
+			{
+				size_t u = eval(o, ancestor, label, semi, path);
+				
+				if (semi[u] < semi[i])
+					semi[i] = semi[u];
+			}
+		}
+		
+		next[i] = bucket[semi[i]];
+		bucket[semi[i]] = i;
+		ancestor[i] = p;
+		
+		for (v = bucket[p]; v; v = next[v])
+		{
+			size_t u = eval(v, ancestor, label, semi, path);
+			
+			idom[v] = (semi[u] < semi[v]) ? u : p;
+		}
+		bucket[p] = 0;
+	}
+	
+	for (i = 2; i <= count; ++i)
+		if (idom[i] != semi[i])
+			idom[i] = idom[idom[i]];
+	
+	
+	/* dominated sections die together with their dominator */
+	for (i = count; i > 1; --i)
+	{
+		section* sec = vertex[i];
+		
+		sec->retained += sec->size;
+		sec->idom = vertex[idom[i]];
+		
+		if (sec->idom)
+			sec->idom->retained += sec->retained;
+		
+		sec->order = 0;
+	}
+	
+	free(vertex);
+	free(parent);
+	free(semi);
+	free(idom);
+	free(ancestor);
+	free(label);
+	free(bucket);
+	free(next);
+	free(path);
+	free(from);
+}
+
+/**@brief Orders sections by decreasing retained size.
+ */
+static int compareRetained(const void* a, const void* b)
+{
+	const section *x = *(const section* const*) a, *y = *(const section* const*) b;
+	
+	if (x->retained != y->retained)
+		return (x->retained < y->retained) ? 1 : -1;
+	
+	return strcmp(x->key, y->key);
+}
+
+/**@brief Adds a section to a group of the savings report.
+ * @param[in] dest   the group
+ * @param[in] size   size of the section
+ * @param[in] align  alignment of the section, a power of two
+ * @param[in] used   \c 1, if the section is kept
+ */
+static void account(savings* dest, unsigned long size, unsigned long align,
+                    int used)
+{
+	/* the linker pads every section up to its alignment */
+	unsigned long padded = (size + align - 1) & ~(align - 1);
+	
+	if (used)
+	{
+		dest->kept += size;
+		dest->keptPadded += padded;
+	}
+	else
+	{
+		dest->removed += size;
+		dest->removedPadded += padded;
+	}
+}
+
+/**@brief Orders groups of the savings report by decreasing removed bytes.
+ */
+static int compareSavings(const void* a, const void* b)
+{
+	const savings *x = (const savings*) a, *y = (const savings*) b;
+	
+	if (x->removed != y->removed)
+		return (x->removed < y->removed) ? 1 : -1;
+	if (x->kept != y->kept)
+		return (x->kept < y->kept) ? 1 : -1;
+	
+	return strcmp(x->name, y->name);
+}
+
+/**@brief Dumps a group of the savings report.
+ */
+static void dumpSavings(FILE* out, const char* tag, const savings* src)
+{
+	fprintf(out, "\t<%s name=\"%.*s\" removed=\"%lu\" kept=\"%lu\" "
+	        "removedPadded=\"%lu\" keptPadded=\"%lu\"/>\n", tag, src->len,
+	        src->name, src->removed, src->kept, src->removedPadded,
+	        src->keptPadded);
+}
+
+/**@brief Orders sections by decreasing number of samples, keeping the link
+ * order otherwise.
+ */
+static int compareSamples(const void* a, const void* b)
+{
+	const section *x = *(const section* const*) a, *y = *(const section* const*) b;
+	
+	if (x->samples != y->samples)
+		return (x->samples < y->samples) ? 1 : -1;
+	
+	return (x->order < y->order) ? -1 : (x->order > y->order);
+}
+
+/**@brief Returns the used function sections in link order.
+ * @note The preorder numbers of the sections are set to their position, the
+ * caller has to reset them.
+ * @param[in]  ctx    analysis context
+ * @param[out] count  number of sections
+ * @return array of sections, which has to be freed by the caller
+ */
+static section** getFunctions(deadstrip* ctx, size_t* count)
+{
+	section** res = (section**) malloc(sizeof(section*) * (listCount(ctx->sections) + 1));
+	
+	*count = 0;
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		list* sects = objectFileGetSections((objectFile*) listGet(ctx->objects));
+		
+		listStart(sects);
+		while (listNext(sects))
+		{
+			const char* name = (const char*) listGet(sects);
+			section* sec = (section*) hashmapGet(ctx->sectionMap, objectFileKey(name));
+			
+			/* sections declared by several objects are listed once */
+			if (!strncmp(name, SO_FUNCTION, sizeof(SO_FUNCTION) - 1)
+			    && graphGetColorNode(sec->node) && !sec->order)
+			{
+				res[*count] = sec;
+				sec->order = ++*count;
+			}
+		}
+	}
+	
+	return res;
+}
+
+/**@brief Returns the cluster of a section, compressing the path to it.
+ * @param[in] parent  union-find forest of the clusters
+ * @param[in] v       position of the section
+ */
+static size_t findCluster(size_t* parent, size_t v)
+{
+	size_t root = v;
+	
+	while (parent[root] != root)
+		root = parent[root];
+	
+	while (parent[v] != root)
+	{
+		size_t next = parent[v];
+		
+		parent[v] = root;
+		v = next;
+	}
+	
+	return root;
+}
+
+/**@brief Orders ranks by decreasing value, keeping the link order otherwise.
+ */
+static int compareRank(const void* a, const void* b)
+{
+	const rank *x = (const rank*) a, *y = (const rank*) b;
+	
+	if (x->value != y->value)
+		return (x->value < y->value) ? 1 : -1;
+	
+	return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+/**@brief Orders sections using the C3 heuristic.
+ * @param[in,out] sects  used function sections in link order, with their
+ *                       preorder numbers set to their 1-based positions
+ * @param[in]     count  number of sections
+ */
+static void cluster(section** sects, size_t count)
+{
+	size_t* caller = (size_t*) calloc(count + 1, sizeof(size_t));
+	unsigned long* weight = (unsigned long*) calloc(count + 1, sizeof(unsigned long));
+	unsigned long* hot = (unsigned long*) calloc(count + 1, sizeof(unsigned long));
+	unsigned long* size = (unsigned long*) malloc(sizeof(unsigned long) * (count + 1));
+	size_t* parent = (size_t*) malloc(sizeof(size_t) * (count + 1));
+	size_t* next = (size_t*) calloc(count + 1, sizeof(size_t));
+	size_t* tail = (size_t*) malloc(sizeof(size_t) * (count + 1));
+	rank* ranks = (rank*) malloc(sizeof(rank) * (count + 1));
+	section** res = (section**) malloc(sizeof(section*) * (count + 1));
+	unsigned long samples = 0;
+	size_t i, n = 0;
+	
+	
+	/* find the heaviest caller of every section */
+	for (i = 1; i <= count; ++i)
+	{
+		list* depends = graphGetConnections(sects[i - 1]->node);
+		list* weights = graphGetWeights(sects[i - 1]->node);
+		
+		samples += sects[i - 1]->samples;
+		
+		listStart(depends);
+		listStart(weights);
+		while (listNext(depends) && listNext(weights))
+		{
+			size_t d = ((section*) graphGetDatum((graph*) listGet(depends)))->order;
+			unsigned long w = (unsigned long) listGet(weights);
+			
+			/* only calls between different functions count */
+			if (!d || d == i)
+				continue;
+			
+			hot[d] += w;
+			if (w > weight[d])
+			{
+				weight[d] = w;
+				caller[d] = i;
+			}
+		}
+	}
+	
+	/* every section starts as a cluster of its own */
+	for (i = 1; i <= count; ++i)
+	{
+		if (samples)
+			hot[i] = sects[i - 1]->samples;
+		
+		parent[i] = tail[i] = i;
+		size[i] = sects[i - 1]->size;
+		ranks[i - 1].value = (double) hot[i];
+		ranks[i - 1].index = i;
+	}
+	
+	
+	/* merge in the order of decreasing hotness */
+	qsort(ranks, count, sizeof(rank), compareRank);
+	
+	for (i = 0; i < count; ++i)
+	{
+		size_t f = ranks[i].index, cf, cp;
+		
+		if (!caller[f])
+			continue;
+		
+		cf = findCluster(parent, f);
+		cp = findCluster(parent, caller[f]);
+		
+		if (cf == cp || size[cf] + size[cp] > SO_CLUSTER)
+			continue;
+		
+		/* the callee's cluster gets appended to the one of the caller */
+		parent[cf] = cp;
+		next[tail[cp]] = cf;
+		tail[cp] = tail[cf];
+		size[cp] += size[cf];
+		hot[cp] += hot[cf];
+	}
+	
+	
+	/* order the clusters by density, their members keep their order */
+	for (i = 1; i <= count; ++i)
+		if (parent[i] == i)
+		{
+			ranks[n].value = (double) hot[i] / (double) (size[i] ? size[i] : 1);
+			ranks[n++].index = i;
+		}
+	
+	qsort(ranks, n, sizeof(rank), compareRank);
+	
+	count = 0;
+	for (i = 0; i < n; ++i)
+	{
+		size_t v;
+		
+		for (v = ranks[i].index; v; v = next[v])
+			res[count++] = sects[v - 1];
+	}
+	
+	memcpy(sects, res, sizeof(section*) * count);
+	
+	free(caller);
+	free(weight);
+	free(hot);
+	free(size);
+	free(parent);
+	free(next);
+	free(tail);
+	free(ranks);
+	free(res);
+}
+
+/**@brief Returns the section of a decorated name or a full section name.
+ */
+static section* find(deadstrip* ctx, const char* name)
+{
+	const char* key = objectFileKey(name);
+	
+	return (section*) hashmapGet(ctx->sectionMap, (key) ? key : name);
+}
+
+/**@brief Makes room for more bytes in a buffer.
+ */
+static void reserve(textBuffer* dest, size_t len)
+{
+	if (dest->count + len <= dest->size)
+		return;
+	
+	while (dest->count + len > dest->size)
+		dest->size = (dest->size) ? dest->size << 1 : 4096;
+	
+	dest->data = (char*) realloc(dest->data, dest->size);
+}
+
+/**@brief Appends a string to a string table.
+ * @return offset of the string
+ */
+static uint32_t intern(textBuffer* dest, const char* src)
+{
+	size_t len = strlen(src) + 1, res = dest->count;
+	
+	reserve(dest, len);
+	memcpy(dest->data + res, src, len);
+	dest->count += len;
+	
+	return (uint32_t) res;
+}
+
+/**@brief Appends formatted text to a buffer.
+ */
+static void format(textBuffer* dest, const char* fmt, ...)
+{
+	va_list args;
+	int len;
+	
+	/* most of the time, the text fits into the remaining space */
+	va_start(args, fmt);
+	len = vsnprintf(dest->data + dest->count, dest->size - dest->count, fmt, args);
+	va_end(args);
+	
+	if ((size_t) len >= dest->size - dest->count)
+	{
+		reserve(dest, len + 1);
+		
+		va_start(args, fmt);
+		vsnprintf(dest->data + dest->count, len + 1, fmt, args);
+		va_end(args);
+	}
+	
+	dest->count += len;
+}
+
+/**@brief Writes the text of a buffer and empties it.
+ */
+static void drain(textBuffer* src, FILE* out)
+{
+	fwrite(src->data, 1, src->count, out);
+	src->count = 0;
+}
+
+/**@brief Orders sections by their names.
+ */
+static int compareNames(const void* a, const void* b)
+{
+	const section *x = *(const section* const*) a, *y = *(const section* const*) b;
+	
+	return strcmp(graphGetNameNode(x->node), graphGetNameNode(y->node));
+}
+
+/**@brief Returns the value of an XML attribute or element in a line of a
+ * dumped map, which gets terminated in place.
+ *
+ * @param[in] line  the line
+ * @param[in] tag   text in front of the value, e.g. <tt>name="</tt>
+ * @return the value or \c NULL, if the tag isn't part of the line
+ */
+static char* attribute(char* line, const char* tag)
+{
+	char* res = strstr(line, tag);
+	
+	if (!res)
+		return 0;
+	
+	res += strlen(tag);
+	res[strcspn(res, "\"<")] = 0;
+	
+	return res;
+}
+
+/**@brief Adds the objects of a binary map to the analysis.
+ * @note References are repeated according to their weights and unknown ones
+ * come from a pseudo section.
+ */
+static void loadBinary(deadstrip* ctx, const depmap* map)
+{
+	const depmapHeader* h = depmapGetHeader(map);
+	uint32_t* decls = (uint32_t*) calloc(h->nodes + 1, sizeof(uint32_t));
+	char* seen = (char*) calloc(h->nodes + 1, 1);
+	uint32_t i, j, k, w, count;
+	
+	/* every declaration of an associated section references it from its
+	 parent again, once the objects get added */
+	for (i = 0; i < h->files; ++i)
+	{
+		const uint32_t* members = depmapGetMembers(map, i, &count);
+		
+		for (j = 0; j < count; ++j)
+			++decls[members[j]];
+	}
+	
+	for (i = 0; i < h->files; ++i)
+	{
+		objectFile* obj = deadstripAddObject(ctx, depmapGetFile(map, i));
+		const uint32_t* members = depmapGetMembers(map, i, &count);
+		const depmapLayout* layouts = depmapGetLayouts(map, i, &count);
+		
+		for (j = 0; j < count; ++j)
+		{
+			const depmapNode* node = depmapGetNode(map, members[j]);
+			const char* key = objectFileKey(depmapGetName(map, members[j]));
+			const depmapEdge* edges;
+			uint32_t edgeCount;
+			
+			if (!key)
+				continue;
+			
+			objectFileAddSection(obj, depmapGetName(map, members[j]),
+			                     layouts[j].size, layouts[j].align);
+			
+			/* the first declaration carries the references */
+			if (seen[members[j]]++)
+				continue;
+			
+			edges = depmapGetEdges(map, members[j], &edgeCount);
+			
+			for (k = 0; k < edgeCount; ++k)
+			{
+				const char* target = depmapGetName(map, edges[k].target);
+				const char* tkey = objectFileKey(target);
+				const char* parent = objectFileParent(target);
+				uint32_t weight = edges[k].weight;
+				
+				if (parent && !strcmp(parent, key))
+					weight -= (weight < decls[edges[k].target])
+						? weight : decls[edges[k].target];
+				
+				for (w = 0; w < weight; ++w)
+					objectFileAddReference(obj, key, (tkey) ? tkey : target);
+			}
+			
+			for (w = 0; w < node->roots; ++w)
+				objectFileAddReference(obj, SO_UNKNOWN, key);
+		}
+	}
+	
+	free(seen);
+	free(decls);
+}
+
+/**@brief Adds the objects of a dumped XML map to the analysis.
+ *
+ * The XML map lacks the references from unknown sections, so they get
+ * derived from the colors: a section that is colored #DEADSTRIP_UNKNOWN
+ * becomes referenced by an unknown one, if no such section references it.
+ *
+ * @param[in]  ctx      analysis context
+ * @param[in]  file     output of deadstripDumpMap()
+ * @param[out] owner    maps the keys to the objects that declare them first
+ * @param[out] unknown  keys of all sections colored #DEADSTRIP_UNKNOWN,
+ *                      which have to be freed by the caller
+ * @return \c 1 on success, \c 0 if the file has an invalid format
+ */
+static int loadXml(deadstrip* ctx, FILE* file, hashmap* owner, list* unknown)
+{
+	hashmap* covered = newHashmap(64);
+	char *line = 0, *curr = 0;
+	size_t size = 0;
+	objectFile* obj = 0;
+	unsigned long color = 0;
+	int res = 0;
+	
+	while (getline(&line, &size, file) > 0)
+	{
+		char *name, *value;
+		
+		if (strstr(line, "<MAP>"))
+			res = 1;
+		
+		/* the sections of the next file follow */
+		else if ((name = attribute(line, "<FILE name=\"")))
+			obj = deadstripAddObject(ctx, name);
+		
+		/* only the first declaration carries the references */
+		else if (obj && strstr(line, "<SECTION name=\""))
+		{
+			/* the values get terminated in place, so the attributes are read
+			 from the last one, older maps lack the size and alignment */
+			char* align = attribute(line, "align=\"");
+			char* bytes = attribute(line, "size=\"");
+			const char* key;
+			
+			value = attribute(line, "color=\"");
+			color = (value) ? strtoul(value, 0, 10) : 0;
+			name = attribute(line, "<SECTION name=\"");
+			key = objectFileKey(name);
+			
+			free(curr);
+			curr = 0;
+			
+			if (!key)
+				continue;
+			
+			objectFileAddSection(obj, name, (bytes) ? strtoul(bytes, 0, 10) : 0,
+			                     (align) ? strtoul(align, 0, 10) : 1);
+			
+			if (hashmapGet(owner, key))
+				continue;
+			
+			hashmapSet(owner, obj, key);
+			curr = strdup(key);
+			
+			if (color & DEADSTRIP_UNKNOWN)
+				listAdd(unknown, strdup(key));
+		}
+		else if (curr && (value = attribute(line, "<DEPENDS>")))
+		{
+			const char* key = objectFileKey(value);
+			const char* parent = objectFileParent(value);
+			
+			/* adding the objects references associated sections anyway */
+			if (!parent || strcmp(parent, curr))
+				objectFileAddReference(obj, curr, (key) ? key : value);
+			
+			if (color & DEADSTRIP_UNKNOWN)
+				hashmapSet(covered, (void*) 1, (key) ? key : value);
+		}
+	}
+	
+	/* sections that can't inherit the color are referenced by unknown ones */
+	listStart(unknown);
+	while (listNext(unknown))
+	{
+		const char* key = (const char*) listGet(unknown);
+		
+		if (!hashmapGet(covered, key))
+			objectFileAddReference((objectFile*) hashmapGet(owner, key),
+			                       SO_UNKNOWN, key);
+	}
+	
+	if (!res)
+		fprintf(stderr, "ERROR: file with dependency map has invalid format!\n");
+	
+	free(curr);
+	free(line);
+	deleteHashmap(covered);
+	
+	return res;
+}
+
+/**@brief Checks, whether a collected section has to be linked, i.e. it's
+ * colored and neither it nor its parent is folded into another one.
+ */
+static int isUsed(deadstrip* ctx, const char* name)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, objectFileKey(name));
+	const char* parent = objectFileParent(name);
+	
+	if (parent)
+	{
+		section* par = (section*) hashmapGet(ctx->sectionMap, parent);
+		
+		if (par && par->fold)
+			return 0;
+	}
+	
+	return graphGetColorNode(sec->node) && !sec->fold;
+}
+
+/**@brief Returns the objects of the analysis as an array.
+ * @note The caller has to free the array.
+ */
+static objectFile** getObjectArray(deadstrip* ctx, size_t* count)
+{
+	objectFile** res = (objectFile**) malloc(sizeof(objectFile*) * (listCount(ctx->objects) + 1));
+	
+	*count = 0;
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+		res[(*count)++] = (objectFile*) listGet(ctx->objects);
+	
+	return res;
+}
+
+/**@brief Looks up the flags of an object or reserves room for them.
+ * @return position of the first flag, 1-based
+ */
+static size_t findUsage(deadstrip* ctx, objectFile* obj, int* found)
+{
+	size_t res;
+	
+	if (!ctx->usageMap)
+		ctx->usageMap = newHashmap(64);
+	
+	res = (size_t) hashmapGet(ctx->usageMap, objectFileGetName(obj));
+	*found = res != 0;
+	
+	if (!res)
+	{
+		size_t count = (size_t) listCount(objectFileGetSections(obj));
+		
+		res = ctx->usage.count + 1;
+		reserve(&ctx->usage, count + 1);
+		ctx->usage.count += count;
+		hashmapSet(ctx->usageMap, (void*) res, objectFileGetName(obj));
+	}
+	
+	return res;
+}
+
+/**@brief Classifies the sections of an object.
+ */
+static void classify(deadstrip* ctx, objectFile* obj, size_t first)
+{
+	list* sects = objectFileGetSections(obj);
+	char* flag = ctx->usage.data + first - 1;
+	
+	listStart(sects);
+	while (listNext(sects))
+		*flag++ = (char) isUsed(ctx, (const char*) listGet(sects));
+}
+
+/**@brief Classifies the sections of a range of objects, whose flags got
+ * reserved already.
+ */
+static void classifyObjects(void* arg, size_t begin, size_t end)
+{
+	objectJob* job = (objectJob*) arg;
+	double start = statsTime();
+	
+	for (; begin < end; ++begin)
+	{
+		objectFile* obj = job->objects[begin];
+		
+		if (job->pending[begin])
+			classify(job->ctx, obj, (size_t) hashmapGet(job->ctx->usageMap,
+			                                            objectFileGetName(obj)));
+	}
+	
+	statsSpan(job->ctx->stats, "worker", "classify", 0, start);
+}
+
+/**@brief Returns the flags of the used sections of an object, in the order
+ * of its sections.
+ * @note The flags of an object are computed once, they stay valid until
+ * colors, folds or objects change.
+ */
+static const unsigned char* getUsage(deadstrip* ctx, objectFile* obj)
+{
+	int found;
+	size_t first = findUsage(ctx, obj, &found);
+	
+	if (!found)
+		classify(ctx, obj, first);
+	
+	return (const unsigned char*) ctx->usage.data + first - 1;
+}
+
+/**@brief Classifies all objects that lack flags in parallel.
+ */
+static void classifyAll(deadstrip* ctx, objectFile** objects, size_t count)
+{
+	objectJob job;
+	size_t i;
+	
+	job.ctx = ctx;
+	job.objects = objects;
+	job.pending = (char*) malloc(count + 1);
+	
+	/* the room gets reserved up front, so the buffer doesn't move anymore */
+	for (i = 0; i < count; ++i)
+	{
+		int found;
+		
+		findUsage(ctx, objects[i], &found);
+		job.pending[i] = (char) !found;
+	}
+	
+	parallelFor(count, ctx->threads, classifyObjects, &job);
+	free(job.pending);
+}
+
+/**@brief Formats the used or unused sections of a range of objects.
+ */
+static void formatSections(void* arg, size_t begin, size_t end)
+{
+	objectJob* job = (objectJob*) arg;
+	double start = statsTime();
+	
+	for (; begin < end; ++begin)
+	{
+		objectFile* obj = job->objects[job->first + begin];
+		textBuffer* text = job->parts + begin;
+		const unsigned char* used = getUsage(job->ctx, obj);
+		list* sects = objectFileGetSections(obj);
+		
+		format(text, "\t<FILE name=\"%s\">\n", objectFileGetName(obj));
+		
+		listStart(sects);
+		while (listNext(sects))
+			if (*used++ == job->used)
+				format(text, "\t\t<SECTION>%s</SECTION>\n", (const char*) listGet(sects));
+		
+		format(text, "\t</FILE>\n");
+	}
+	
+	statsSpan(job->ctx->stats, "worker", "format", 0, start);
+}
+
+/**@brief Dumps a list of sections per object, either the used or the unused
+ * ones.
+ * @note Batches of objects are formatted in parallel and written in order.
+ */
+static void dumpSections(deadstrip* ctx, FILE* out, const char* tag, int used)
+{
+	objectJob job;
+	size_t count, i, j;
+	
+	job.ctx = ctx;
+	job.objects = getObjectArray(ctx, &count);
+	job.parts = (textBuffer*) calloc(SO_BATCH, sizeof(textBuffer));
+	job.used = used;
+	
+	/* the threads only read the flags */
+	classifyAll(ctx, job.objects, count);
+	
+	fprintf(out, "\n<%s>\n", tag);
+	
+	for (i = 0; i < count; i += SO_BATCH)
+	{
+		size_t batch = (count - i < SO_BATCH) ? count - i : SO_BATCH;
+		
+		job.first = i;
+		parallelFor(batch, ctx->threads, formatSections, &job);
+		
+		for (j = 0; j < batch; ++j)
+			drain(job.parts + j, out);
+	}
+	
+	fprintf(out, "</%s>\n", tag);
+	
+	for (i = 0; i < SO_BATCH; ++i)
+		free(job.parts[i].data);
+	
+	free(job.parts);
+	free(job.objects);
+}
+
+/**@brief Appends a string in double quotes, escaped for DOT and JSON.
+ */
+static void quote(textBuffer* dest, const char* src)
+{
+	reserve(dest, strlen(src) * 6 + 3);
+	dest->data[dest->count++] = '"';
+	
+	for (; *src; ++src)
+	{
+		if (*src == '"' || *src == '\\')
+			dest->data[dest->count++] = '\\';
+		else if ((unsigned char) *src < ' ')
+		{
+			dest->count += sprintf(dest->data + dest->count, "\\u%04x", *src);
+			continue;
+		}
+		
+		dest->data[dest->count++] = *src;
+	}
+	
+	dest->data[dest->count++] = '"';
+}
+
+/**@brief Checks, whether a section passes the filter of an emitted graph.
+ */
+static int isEmitted(deadstrip* ctx, section* sec, int mode)
+{
+	int used;
+	
+	if (!sec->decl)
+		return 0;
+	
+	if (!(mode & (DEADSTRIP_EMIT_LIVE | DEADSTRIP_EMIT_DEAD)))
+		return 1;
+	
+	used = isUsed(ctx, graphGetNameNode(sec->node));
+	return (mode & ((used) ? DEADSTRIP_EMIT_LIVE : DEADSTRIP_EMIT_DEAD)) != 0;
+}
+
+/**@brief Marks the emitted sections within a number of references of a
+ * section, breadth first in both directions.
+ * @note The marked sections are kept in the region of the context.
+ */
+static void markAround(deadstrip* ctx, section* root, int mode, int depth)
+{
+	size_t begin = 0, end;
+	
+	if (!isEmitted(ctx, root, mode))
+		return;
+	
+	root->mark = 1;
+	push(&ctx->region, root->node);
+	
+	/* every round adds the sections one reference further away */
+	for (; depth && begin < ctx->region.count; --depth)
+	{
+		for (end = ctx->region.count; begin < end; ++begin)
+		{
+			list* next[2];
+			int i;
+			
+			next[0] = graphGetConnections(ctx->region.data[begin]);
+			next[1] = graphGetPredecessors(ctx->region.data[begin]);
+			
+			for (i = 0; i < 2; ++i)
+			{
+				listStart(next[i]);
+				while (listNext(next[i]))
+				{
+					graph* node = (graph*) listGet(next[i]);
+					section* sec = (section*) graphGetDatum(node);
+					
+					if (!sec->mark && isEmitted(ctx, sec, mode))
+					{
+						sec->mark = 1;
+						push(&ctx->region, node);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**@brief Emits the sections as nodes and their references as edges.
+ * @param[in] sects  emitted sections, their order is the object index plus one
+ */
+static void emitSections(deadstrip* ctx, FILE* out, int mode, section** sects,
+                         size_t count, objectFile** objects)
+{
+	int json = mode & DEADSTRIP_EMIT_JSON;
+	size_t edges = 0, i;
+	textBuffer text;
+	
+	memset(&text, 0, sizeof(text));
+	format(&text, (json) ? "{\"nodes\":[" : "digraph deadstrip {\n");
+	
+	for (i = 0; i < count; ++i)
+	{
+		const char* name = graphGetNameNode(sects[i]->node);
+		int used = isUsed(ctx, name);
+		
+		if (json)
+		{
+			format(&text, "%s\n{\"name\":", (i) ? "," : "");
+			quote(&text, name);
+			format(&text, ",\"object\":");
+			quote(&text, objectFileGetName(objects[sects[i]->order - 1]));
+			format(&text, ",\"used\":%s,\"color\":%lu,\"size\":%lu}",
+			       (used) ? "true" : "false", graphGetColorNode(sects[i]->node),
+			       sects[i]->size);
+		}
+		else
+		{
+			format(&text, "\t");
+			quote(&text, name);
+			format(&text, " [shape=%s%s];\n",
+			       (strncmp(name, SO_FUNCTION, sizeof(SO_FUNCTION) - 1)) ? "ellipse" : "box",
+			       (used) ? "" : ", style=dashed, color=gray");
+		}
+		
+		if (text.count >= SO_BUFFER)
+			drain(&text, out);
+	}
+	
+	if (json)
+		format(&text, "\n],\"edges\":[");
+	
+	for (i = 0; i < count; ++i)
+	{
+		list* depend = graphGetConnections(sects[i]->node);
+		list* weights = graphGetWeights(sects[i]->node);
+		
+		listStart(depend);
+		listStart(weights);
+		while (listNext(depend) && listNext(weights))
+		{
+			graph* d = (graph*) listGet(depend);
+			
+			if (!((section*) graphGetDatum(d))->order)
+				continue;
+			
+			if (json)
+			{
+				format(&text, "%s\n{\"source\":", (edges++) ? "," : "");
+				quote(&text, graphGetNameNode(sects[i]->node));
+				format(&text, ",\"target\":");
+				quote(&text, graphGetNameNode(d));
+				format(&text, ",\"weight\":%lu}", (unsigned long) listGet(weights));
+			}
+			else
+			{
+				format(&text, "\t");
+				quote(&text, graphGetNameNode(sects[i]->node));
+				format(&text, " -> ");
+				quote(&text, graphGetNameNode(d));
+				format(&text, ";\n");
+			}
+		}
+		
+		if (text.count >= SO_BUFFER)
+			drain(&text, out);
+	}
+	
+	format(&text, (json) ? "\n]}\n" : "}\n");
+	drain(&text, out);
+	free(text.data);
+}
+
+/**@brief Emits the objects as nodes and the summed up references between
+ * their sections as edges.
+ * @param[in] sects  emitted sections, their order is the object index plus one
+ */
+static void emitObjects(deadstrip* ctx, FILE* out, int mode, section** sects,
+                        size_t count, objectFile** objects, size_t objectCount)
+{
+	int json = mode & DEADSTRIP_EMIT_JSON;
+	unsigned long* weight = (unsigned long*) calloc(objectCount + 1, sizeof(unsigned long));
+	size_t* touched = (size_t*) malloc(sizeof(size_t) * (objectCount + 1));
+	size_t nodes = 0, edges = 0, begin, end, i;
+	textBuffer text;
+	
+	memset(&text, 0, sizeof(text));
+	format(&text, (json) ? "{\"nodes\":[" : "digraph deadstrip {\n");
+	
+	/* the sections of an object follow each other */
+	for (begin = 0; begin < count; begin = end)
+	{
+		const char* name = objectFileGetName(objects[sects[begin]->order - 1]);
+		unsigned long used = 0, size = 0;
+		
+		for (end = begin; end < count && sects[end]->order == sects[begin]->order; ++end)
+		{
+			used += isUsed(ctx, graphGetNameNode(sects[end]->node));
+			size += sects[end]->size;
+		}
+		
+		if (json)
+		{
+			format(&text, "%s\n{\"name\":", (nodes++) ? "," : "");
+			quote(&text, name);
+			format(&text, ",\"sections\":%lu,\"used\":%lu,\"size\":%lu}",
+			       (unsigned long) (end - begin), used, size);
+		}
+		else
+		{
+			format(&text, "\t");
+			quote(&text, name);
+			format(&text, " [shape=folder%s];\n",
+			       (used) ? "" : ", style=dashed, color=gray");
+		}
+		
+		if (text.count >= SO_BUFFER)
+			drain(&text, out);
+	}
+	
+	if (json)
+		format(&text, "\n],\"edges\":[");
+	
+	for (begin = 0; begin < count; begin = end)
+	{
+		size_t src = sects[begin]->order, touches = 0;
+		
+		/* sum up the references of all sections of the object */
+		for (end = begin; end < count && sects[end]->order == src; ++end)
+		{
+			list* depend = graphGetConnections(sects[end]->node);
+			list* weights = graphGetWeights(sects[end]->node);
+			
+			listStart(depend);
+			listStart(weights);
+			while (listNext(depend) && listNext(weights))
+			{
+				size_t dest = ((section*) graphGetDatum((graph*) listGet(depend)))->order;
+				
+				if (!dest || dest == src)
+					continue;
+				
+				if (!weight[dest])
+					touched[touches++] = dest;
+				
+				weight[dest] += (unsigned long) listGet(weights);
+			}
+		}
+		
+		for (i = 0; i < touches; ++i)
+		{
+			if (json)
+			{
+				format(&text, "%s\n{\"source\":", (edges++) ? "," : "");
+				quote(&text, objectFileGetName(objects[src - 1]));
+				format(&text, ",\"target\":");
+				quote(&text, objectFileGetName(objects[touched[i] - 1]));
+				format(&text, ",\"weight\":%lu}", weight[touched[i]]);
+			}
+			else
+			{
+				format(&text, "\t");
+				quote(&text, objectFileGetName(objects[src - 1]));
+				format(&text, " -> ");
+				quote(&text, objectFileGetName(objects[touched[i] - 1]));
+				format(&text, " [label=\"%lu\"];\n", weight[touched[i]]);
+			}
+			
+			weight[touched[i]] = 0;
+		}
+		
+		if (text.count >= SO_BUFFER)
+			drain(&text, out);
+	}
+	
+	format(&text, (json) ? "\n]}\n" : "}\n");
+	drain(&text, out);
+	free(text.data);
+	free(touched);
+	free(weight);
+}
+
+/* ******************************************************* exported functions */
+
+deadstrip* newDeadstrip()
+{
+	deadstrip* ctx = (deadstrip*) malloc(sizeof(deadstrip));
+	
+	ctx->sectionMap = newHashmap(8);
+	ctx->objectMap = newHashmap(8);
+	ctx->objects = newList();
+	ctx->sections = newList();
+	ctx->seeds = newList();
+	ctx->suspects = newList();
+	ctx->stack.data = ctx->region.data = 0;
+	ctx->stack.count = ctx->region.count = 0;
+	ctx->stack.size = ctx->region.size = 0;
+	ctx->usage.data = 0;
+	ctx->usage.count = ctx->usage.size = 0;
+	ctx->usageMap = 0;
+	ctx->threads = 1;
+	ctx->stats = 0;
+	
+	return ctx;
+}
+
+void deleteDeadstrip(deadstrip* ctx)
+{
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+	{
+		section* sec = (section*) listGet(ctx->sections);
+		
+		deleteGraph(sec->node);
+		free(sec->key);
+		free(sec);
+	}
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+		objectFileDelete((objectFile*) listGet(ctx->objects));
+	
+	invalidate(ctx);
+	free(ctx->usage.data);
+	deleteList(ctx->sections);
+	deleteList(ctx->seeds);
+	deleteList(ctx->suspects);
+	deleteList(ctx->objects);
+	free(ctx->stack.data);
+	free(ctx->region.data);
+	deleteHashmap(ctx->objectMap);
+	deleteHashmap(ctx->sectionMap);
+	free(ctx);
+}
+
+objectFile* deadstripAddObject(deadstrip* ctx, const char* name)
+{
+	objectFile* obj = (objectFile*) hashmapGet(ctx->objectMap, name);
+	
+	if (!obj)
+	{
+		obj = objectFileCreate(name);
+		hashmapSet(ctx->objectMap, obj, name);
+		invalidate(ctx);
+		
+		/* keep the order of the objects */
+		while (listNext(ctx->objects));
+		listAdd(ctx->objects, obj);
+	}
+	
+	return obj;
+}
+
+int deadstripSyncObjects(deadstrip* ctx, list* names)
+{
+	hashmap* objectMap = newHashmap(listCount(names));
+	list* objects = newList();
+	int stale = 0;
+	
+	/* reuse the objects that are known already */
+	listStart(names);
+	while (listNext(names))
+	{
+		const char* name = (const char*) listGet(names);
+		objectFile* obj;
+		
+		if (hashmapGet(objectMap, name))
+			continue;
+		
+		obj = (objectFile*) hashmapRemove(ctx->objectMap, name);
+		
+		if (!obj)
+			obj = objectFileCreate(name);
+		
+		stale += objectFileRefresh(obj);
+		hashmapSet(objectMap, obj, name);
+		listAdd(objects, obj);
+	}
+	
+	/* the ones left over aren't used anymore */
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* obj = (objectFile*) listGet(ctx->objects);
+		
+		if (hashmapGet(ctx->objectMap, objectFileGetName(obj)) != obj)
+			listRemove(ctx->objects);
+	}
+	
+	contribute(ctx, ctx->objects, 0);
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+		objectFileDelete((objectFile*) listGet(ctx->objects));
+	
+	deleteList(ctx->objects);
+	deleteHashmap(ctx->objectMap);
+	ctx->objects = objects;
+	ctx->objectMap = objectMap;
+	
+	uncolorize(ctx);
+	return stale;
+}
+
+list* deadstripGetObjects(deadstrip* ctx)
+{
+	return ctx->objects;
+}
+
+int deadstripCollect(deadstrip* ctx, FILE* file)
+{
+	list* stale = newList();
+	int res;
+	
+	/* withdraw the old state of the stale objects */
+	statsPhase(ctx->stats, "graph");
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* obj = (objectFile*) listGet(ctx->objects);
+		
+		if (objectFileIsStale(obj))
+			listAdd(stale, obj);
+	}
+	
+	contribute(ctx, stale, 0);
+	statsPhase(ctx->stats, "parse");
+	res = objectFileCollect(ctx->objects, file, ctx->stats);
+	statsPhase(ctx->stats, "graph");
+	
+	/* additions come first, so only truly unreachable sections lose colors */
+	contribute(ctx, stale, 1);
+	
+	uncolorize(ctx);
+	deleteList(stale);
+	
+	return res;
+}
+
+int deadstripCompute(deadstrip* ctx, FILE* file)
+{
+	return deadstripCollect(ctx, file);
+}
+
+void deadstripColorize(deadstrip* ctx, const char* seed, unsigned long color)
+{
+	if (seed && *seed)
+		plant(ctx, lookup(ctx, seed), color, 1);
+}
+
+void deadstripUncolorize(deadstrip* ctx, const char* seed, unsigned long color)
+{
+	section* sec = (seed && *seed)
+		? (section*) hashmapGet(ctx->sectionMap, seed) : 0;
+	
+	if (sec)
+	{
+		plant(ctx, sec, color, 0);
+		uncolorize(ctx);
+	}
+}
+
+void deadstripSyncSeeds(deadstrip* ctx, list* seeds, unsigned long color)
+{
+	/* mark the new seeds */
+	listStart(seeds);
+	while (listNext(seeds))
+	{
+		const char* key = (const char*) listGet(seeds);
+		
+		if (*key)
+			lookup(ctx, key)->mark = 1;
+	}
+	
+	/* remove the old ones that aren't marked, the list may shrink meanwhile */
+	listStart(ctx->seeds);
+	while (listNext(ctx->seeds))
+	{
+		section* sec = (section*) listGet(ctx->seeds);
+		
+		if (!sec->mark && (sec->seed & color))
+		{
+			sec->seed &= ~color;
+			listAdd(ctx->suspects, sec);
+			
+			if (!sec->seed)
+				listRemove(ctx->seeds);
+		}
+	}
+	
+	/* add the new ones */
+	listStart(seeds);
+	while (listNext(seeds))
+	{
+		const char* key = (const char*) listGet(seeds);
+		
+		if (*key)
+		{
+			section* sec = lookup(ctx, key);
+			
+			sec->mark = 0;
+			if (!(sec->seed & color))
+				plant(ctx, sec, color, 1);
+		}
+	}
+	
+	uncolorize(ctx);
+}
+
+void deadstripConnect(deadstrip* ctx, const char* src, const char* dest)
+{
+	reference(ctx, (src) ? lookup(ctx, src) : 0, lookup(ctx, dest), 1);
+}
+
+void deadstripDisconnect(deadstrip* ctx, const char* src, const char* dest)
+{
+	section* s = (src) ? (section*) hashmapGet(ctx->sectionMap, src) : 0;
+	section* d = (section*) hashmapGet(ctx->sectionMap, dest);
+	
+	if (d && (s || !src))
+	{
+		reference(ctx, s, d, 0);
+		uncolorize(ctx);
+	}
+}
+
+unsigned long deadstripVerify(deadstrip* ctx)
+{
+	unsigned long* colors = (unsigned long*)
+		malloc(sizeof(unsigned long) * (listCount(ctx->sections) + 1));
+	unsigned long res = 0, i = 0;
+	
+	/* remember the maintained colors and start over */
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+	{
+		graph* node = ((section*) listGet(ctx->sections))->node;
+		
+		colors[i++] = graphGetColorNode(node);
+		graphColorNode(node, 0);
+	}
+	
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+	{
+		section* sec = (section*) listGet(ctx->sections);
+		
+		if (rootColor(sec))
+			colorizeGraph(ctx, sec->node, rootColor(sec));
+	}
+	
+	/* compare */
+	i = 0;
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+		if (graphGetColorNode(((section*) listGet(ctx->sections))->node)
+		    != colors[i++])
+			++res;
+	
+	free(colors);
+	return res;
+}
+
+unsigned long deadstripGetColor(deadstrip* ctx, const char* key)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	return (sec && sec->decl) ? graphGetColorNode(sec->node) : 0;
+}
+
+void deadstripFold(deadstrip* ctx, const char* key, const char* rep)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	if (sec)
+		sec->fold = (rep) ? (section*) hashmapGet(ctx->sectionMap, rep) : 0;
+	
+	invalidate(ctx);
+}
+
+void deadstripClearFolds(deadstrip* ctx)
+{
+	invalidate(ctx);
+	
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+		((section*) listGet(ctx->sections))->fold = 0;
+}
+
+const char* deadstripGetFold(deadstrip* ctx, const char* key)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	return (sec && sec->fold) ? sec->fold->key : 0;
+}
+
+void deadstripSetThreads(deadstrip* ctx, int threads)
+{
+	ctx->threads = threads;
+}
+
+void deadstripSetStats(deadstrip* ctx, stats* st)
+{
+	ctx->stats = st;
+}
+
+stats* deadstripGetStats(deadstrip* ctx)
+{
+	return ctx->stats;
+}
+
+void deadstripGetCounts(deadstrip* ctx, deadstripCounts* dest)
+{
+	dest->objects = listCount(ctx->objects);
+	dest->sections = dest->relocations = dest->edges = 0;
+	
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+	{
+		section* sec = (section*) listGet(ctx->sections);
+		list* weights = graphGetWeights(sec->node);
+		
+		dest->sections += sec->decl != 0;
+		dest->relocations += sec->roots;
+		
+		listStart(weights);
+		while (listNext(weights))
+		{
+			dest->relocations += (unsigned long) listGet(weights);
+			++dest->edges;
+		}
+	}
+}
+
+objectFile* deadstripGetObject(deadstrip* ctx, const char* name)
+{
+	return (objectFile*) hashmapGet(ctx->objectMap, name);
+}
+
+int deadstripIsDead(deadstrip* ctx, objectFile* src)
+{
+	list* sects = objectFileGetSections(src);
+	const unsigned char* used;
+	
+	if (objectFileIsStale(src) || objectFileIsPinned(src))
+		return 0;
+	
+	used = getUsage(ctx, src);
+	
+	listStart(sects);
+	while (listNext(sects))
+		if (*used++)
+			return 0;
+	
+	return 1;
+}
+
+list* deadstripGetUsed(deadstrip* ctx, objectFile* src)
+{
+	list* res = newList();
+	list* sects = objectFileGetSections(src);
+	const unsigned char* used = getUsage(ctx, src);
+	
+	listStart(sects);
+	while (listNext(sects))
+		if (*used++)
+			listAdd(res, listGet(sects));
+	
+	return res;
+}
+
+list* deadstripGetUnused(deadstrip* ctx, objectFile* src)
+{
+	list* res = newList();
+	list* sects = objectFileGetSections(src);
+	const unsigned char* used = getUsage(ctx, src);
+	
+	listStart(sects);
+	while (listNext(sects))
+		if (!*used++)
+			listAdd(res, listGet(sects));
+	
+	return res;
+}
+
+list* deadstripGetChain(deadstrip* ctx, const char* name)
+{
+	list* res = newList();
+	section *sec = find(ctx, name), *root = 0;
+	unsigned long color;
+	size_t head = 0, i;
+	
+	if (!sec || !sec->decl || !(color = graphGetColorNode(sec->node)))
+		return res;
+	
+	
+	/* breadth first search along the predecessors, only colored sections can
+	 lie on the way from a root */
+	sec->mark = 1;
+	sec->via = 0;
+	push(&ctx->region, sec->node);
+	
+	while (head < ctx->region.count)
+	{
+		graph* node = ctx->region.data[head++];
+		section* curr = (section*) graphGetDatum(node);
+		list* pred;
+		
+		if (rootColor(curr) & color)
+		{
+			root = curr;
+			break;
+		}
+		
+		pred = graphGetPredecessors(node);
+		listStart(pred);
+		while (listNext(pred))
+		{
+			graph* p = (graph*) listGet(pred);
+			section* s = (section*) graphGetDatum(p);
+			
+			if (!s->mark && (graphGetColorNode(p) & color))
+			{
+				s->mark = 1;
+				s->via = curr;
+				push(&ctx->region, p);
+			}
+		}
+	}
+	
+	for (; root; root = root->via)
+		listAdd(res, graphGetNameNode(root->node));
+	
+	for (i = 0; i < ctx->region.count; ++i)
+		((section*) graphGetDatum(ctx->region.data[i]))->mark = 0;
+	
+	ctx->region.count = 0;
+	return res;
+}
+
+list* deadstripGetReferrers(deadstrip* ctx, const char* name)
+{
+	list* res = newList();
+	section* sec = find(ctx, name);
+	
+	if (sec)
+	{
+		list* pred = graphGetPredecessors(sec->node);
+		
+		listStart(pred);
+		while (listNext(pred))
+		{
+			graph* p = (graph*) listGet(pred);
+			
+			if (((section*) graphGetDatum(p))->decl)
+				listAdd(res, graphGetNameNode(p));
+		}
+	}
+	
+	return res;
+}
+
+unsigned long deadstripGetSize(deadstrip* ctx, const char* key)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	return (sec) ? sec->size : 0;
+}
+
+void deadstripDominate(deadstrip* ctx)
+{
+	dominate(ctx);
+}
+
+unsigned long deadstripGetRetained(deadstrip* ctx, const char* key)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	return (sec) ? sec->retained : 0;
+}
+
+const char* deadstripGetDominator(deadstrip* ctx, const char* key)
+{
+	section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+	
+	return (sec && sec->idom) ? graphGetNameNode(sec->idom->node) : 0;
+}
+
+void deadstripDumpMap(deadstrip* ctx, FILE* out)
+{
+	textBuffer text;
+	
+	memset(&text, 0, sizeof(text));
+	
+	/* yay ^_^, what a loop */
+	format(&text, "\n<MAP>\n");
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* oFile = (objectFile*) listGet(ctx->objects);
+		list* sects = objectFileGetSections(oFile);
+		list* sizes = objectFileGetSizes(oFile);
+		list* aligns = objectFileGetAlignments(oFile);
+		
+		format(&text, "\t<FILE name=\"%s\">\n", objectFileGetName(oFile));
+		
+		listStart(sects);
+		listStart(sizes);
+		listStart(aligns);
+		while (listNext(sects) && listNext(sizes) && listNext(aligns))
+		{
+			graph* sect = getNode(ctx, (const char*) listGet(sects));
+			list* depend = graphGetConnections(sect);
+			
+			/* the size and alignment belong to this declaration */
+			format(&text, "\t\t<SECTION name=\"%s\" color=\"%lu\" size=\"%lu\" "
+			       "align=\"%lu\">\n", graphGetNameNode(sect), graphGetColorNode(sect),
+			       (unsigned long) listGet(sizes), (unsigned long) listGet(aligns));
+			
+			listStart(depend);
+			while (listNext(depend))
+			{
+				graph* d = (graph*) listGet(depend);
+				
+				/* references to other files aren't sections */
+				if (!((section*) graphGetDatum(d))->decl)
+					continue;
+				
+				format(&text, "\t\t\t<DEPENDS>%s</DEPENDS>\n", graphGetNameNode(d));
+			}
+			
+			format(&text, "\t\t</SECTION>\n");
+		}
+		format(&text, "\t</FILE>\n");
+		
+		if (text.count >= SO_BUFFER)
+			drain(&text, out);
+	}
+	format(&text, "\n</MAP>\n");
+	drain(&text, out);
+	free(text.data);
+}
+
+int deadstripWriteMap(deadstrip* ctx, FILE* out)
+{
+	size_t count = 0, members = 0, edges = 0, i;
+	section** sects = (section**) malloc(sizeof(section*) * (listCount(ctx->sections) + 1));
+	depmapFile* files = (depmapFile*) malloc(sizeof(depmapFile) * (listCount(ctx->objects) + 1));
+	depmapNode* nodes;
+	depmapEdge* edge;
+	depmapLayout* layout;
+	uint32_t* member;
+	textBuffer strings;
+	depmapHeader header;
+	int res;
+	
+	memset(&strings, 0, sizeof(strings));
+	memset(&header, 0, sizeof(header));
+	
+	/* the sentinels are named by an empty string */
+	intern(&strings, "");
+	
+	
+	/* number the declared sections in link order */
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* obj = (objectFile*) listGet(ctx->objects);
+		list* decl = objectFileGetSections(obj);
+		
+		files[header.files].name = intern(&strings, objectFileGetName(obj));
+		files[header.files++].first = (uint32_t) members;
+		
+		listStart(decl);
+		while (listNext(decl))
+		{
+			section* sec = find(ctx, (const char*) listGet(decl));
+			
+			if (!sec->order)
+			{
+				sects[count] = sec;
+				sec->order = ++count;
+			}
+			
+			++members;
+		}
+	}
+	
+	files[header.files].name = 0;
+	files[header.files].first = (uint32_t) members;
+	
+	
+	/* fill the member, layout, node and edge tables */
+	member = (uint32_t*) malloc(sizeof(uint32_t) * (members + 1));
+	layout = (depmapLayout*) malloc(sizeof(depmapLayout) * (members + 1));
+	nodes = (depmapNode*) malloc(sizeof(depmapNode) * (count + 1));
+	members = 0;
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* obj = (objectFile*) listGet(ctx->objects);
+		list* decl = objectFileGetSections(obj);
+		list* sizes = objectFileGetSizes(obj);
+		list* aligns = objectFileGetAlignments(obj);
+		
+		listStart(decl);
+		listStart(sizes);
+		listStart(aligns);
+		while (listNext(decl) && listNext(sizes) && listNext(aligns))
+		{
+			layout[members].size = (uint32_t) (unsigned long) listGet(sizes);
+			layout[members].align = (uint32_t) (unsigned long) listGet(aligns);
+			member[members++] = (uint32_t) find(ctx, (const char*) listGet(decl))->order - 1;
+		}
+	}
+	
+	for (i = 0; i < count; ++i)
+	{
+		list* depend = graphGetConnections(sects[i]->node);
+		
+		nodes[i].name = intern(&strings, graphGetNameNode(sects[i]->node));
+		nodes[i].color = (uint32_t) graphGetColorNode(sects[i]->node);
+		nodes[i].size = (uint32_t) sects[i]->size;
+		nodes[i].roots = sects[i]->roots;
+		nodes[i].first = (uint32_t) edges;
+		
+		listStart(depend);
+		while (listNext(depend))
+			edges += ((section*) graphGetDatum((graph*) listGet(depend)))->order != 0;
+	}
+	
+	nodes[count].name = 0;
+	nodes[count].color = nodes[count].size = nodes[count].roots = 0;
+	nodes[count].first = (uint32_t) edges;
+	
+	edge = (depmapEdge*) malloc(sizeof(depmapEdge) * (edges + 1));
+	edges = 0;
+	
+	for (i = 0; i < count; ++i)
+	{
+		list* depend = graphGetConnections(sects[i]->node);
+		list* weights = graphGetWeights(sects[i]->node);
+		
+		listStart(depend);
+		listStart(weights);
+		while (listNext(depend) && listNext(weights))
+		{
+			size_t o = ((section*) graphGetDatum((graph*) listGet(depend)))->order;
+			
+			/* references to other files aren't sections */
+			if (!o)
+				continue;
+			
+			edge[edges].target = (uint32_t) o - 1;
+			edge[edges++].weight = (uint32_t) (unsigned long) listGet(weights);
+		}
+	}
+	
+	
+	/* the name index gets written from the sorted sections */
+	qsort(sects, count, sizeof(section*), compareNames);
+	
+	
+	/* the tables follow the header in this order, all sizes are multiples of
+	 four, except for the strings at the end */
+	memcpy(header.magic, DEPMAP_MAGIC, sizeof(header.magic));
+	header.version = DEPMAP_VERSION;
+	header.members = (uint32_t) members;
+	header.nodes = (uint32_t) count;
+	header.edges = (uint32_t) edges;
+	header.strings = (uint32_t) strings.count;
+	header.fileOffset = sizeof(depmapHeader);
+	header.memberOffset = header.fileOffset + sizeof(depmapFile) * (header.files + 1);
+	header.layoutOffset = header.memberOffset + sizeof(uint32_t) * header.members;
+	header.nodeOffset = header.layoutOffset + sizeof(depmapLayout) * header.members;
+	header.edgeOffset = header.nodeOffset + sizeof(depmapNode) * (header.nodes + 1);
+	header.indexOffset = header.edgeOffset + sizeof(depmapEdge) * header.edges;
+	header.stringOffset = header.indexOffset + sizeof(uint32_t) * header.nodes;
+	
+	res = fwrite(&header, sizeof(header), 1, out) == 1
+	      && fwrite(files, sizeof(depmapFile), header.files + 1, out) == header.files + 1
+	      && fwrite(member, sizeof(uint32_t), members, out) == members
+	      && fwrite(layout, sizeof(depmapLayout), members, out) == members
+	      && fwrite(nodes, sizeof(depmapNode), count + 1, out) == count + 1
+	      && fwrite(edge, sizeof(depmapEdge), edges, out) == edges;
+	
+	for (i = 0; res && i < count; ++i)
+	{
+		uint32_t index = (uint32_t) sects[i]->order - 1;
+		res = fwrite(&index, sizeof(index), 1, out) == 1;
+	}
+	
+	res = res && fwrite(strings.data, 1, strings.count, out) == strings.count;
+	
+	for (i = 0; i < count; ++i)
+		sects[i]->order = 0;
+	
+	free(strings.data);
+	free(edge);
+	free(nodes);
+	free(layout);
+	free(member);
+	free(files);
+	free(sects);
+	
+	return res;
+}
+
+void deadstripDumpUsed(deadstrip* ctx, FILE* out)
+{
+	dumpSections(ctx, out, "USED", 1);
+}
+
+void deadstripDumpUnused(deadstrip* ctx, FILE* out)
+{
+	dumpSections(ctx, out, "UNUSED", 0);
+}
+
+void deadstripDumpWhy(deadstrip* ctx, const char* name, FILE* out)
+{
+	list* chain = deadstripGetChain(ctx, name);
+	int first = 1;
+	
+	fprintf(out, "\n<WHY section=\"%s\">\n", name);
+	
+	listStart(chain);
+	while (listNext(chain))
+	{
+		const char* curr = (const char*) listGet(chain);
+		
+		/* the chain starts with a seed or a section that is referenced by an
+		 unknown one */
+		if (first)
+			fprintf(out, "\t<ROOT kind=\"%s\">%s</ROOT>\n",
+			        (find(ctx, curr)->seed) ? "seed" : "unknown", curr);
+		else
+			fprintf(out, "\t<SECTION>%s</SECTION>\n", curr);
+		
+		first = 0;
+	}
+	
+	fprintf(out, "</WHY>\n");
+	deleteList(chain);
+}
+
+void deadstripDumpReferrers(deadstrip* ctx, const char* name, FILE* out)
+{
+	list* users = deadstripGetReferrers(ctx, name);
+	section* sec = find(ctx, name);
+	
+	fprintf(out, "\n<USERS section=\"%s\">\n", name);
+	
+	listStart(users);
+	while (listNext(users))
+		fprintf(out, "\t<SECTION>%s</SECTION>\n", (const char*) listGet(users));
+	
+	/* references from sections outside of the known prefixes */
+	if (sec && sec->roots)
+		fprintf(out, "\t<UNKNOWN>%u</UNKNOWN>\n", sec->roots);
+	
+	fprintf(out, "</USERS>\n");
+	deleteList(users);
+}
+
+void deadstripDumpRetained(deadstrip* ctx, FILE* out)
+{
+	size_t count = 0, i;
+	section** used;
+	
+	dominate(ctx);
+	used = (section**) malloc(sizeof(section*) * (listCount(ctx->sections) + 1));
+	
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+	{
+		section* sec = (section*) listGet(ctx->sections);
+		
+		if (sec->decl && graphGetColorNode(sec->node))
+			used[count++] = sec;
+	}
+	
+	qsort(used, count, sizeof(section*), compareRetained);
+	
+	fprintf(out, "\n<RETAINED>\n");
+	for (i = 0; i < count; ++i)
+	{
+		fprintf(out, "\t<SECTION size=\"%lu\" retained=\"%lu\"",
+		        used[i]->size, used[i]->retained);
+		
+		if (used[i]->idom)
+			fprintf(out, " dominator=\"%s\"", graphGetNameNode(used[i]->idom->node));
+		
+		fprintf(out, ">%s</SECTION>\n", graphGetNameNode(used[i]->node));
+	}
+	fprintf(out, "</RETAINED>\n");
+	
+	free(used);
+}
+
+void deadstripDumpSavings(deadstrip* ctx, FILE* out)
+{
+	savings *files = (savings*) calloc(listCount(ctx->objects) + 1, sizeof(savings)),
+	        *kinds = 0, total;
+	size_t fileCount = 0, kindCount = 0, i;
+	
+	memset(&total, 0, sizeof(total));
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* obj = (objectFile*) listGet(ctx->objects);
+		list* sects = objectFileGetSections(obj);
+		list* sizes = objectFileGetSizes(obj);
+		list* aligns = objectFileGetAlignments(obj);
+		const unsigned char* flag = getUsage(ctx, obj);
+		savings* file = files + fileCount++;
+		
+		file->name = objectFileGetName(obj);
+		file->len = (int) strlen(file->name);
+		
+		listStart(sects);
+		listStart(sizes);
+		listStart(aligns);
+		while (listNext(sects) && listNext(sizes) && listNext(aligns))
+		{
+			const char* name = (const char*) listGet(sects);
+			unsigned long size = (unsigned long) listGet(sizes);
+			unsigned long align = (unsigned long) listGet(aligns);
+			int used = *flag++;
+			const char* parent = objectFileParent(name);
+			int len = (int) (((parent) ? parent : objectFileKey(name)) - name);
+			
+			/* the kind of a section is its prefix */
+			for (i = 0; i < kindCount; ++i)
+				if (kinds[i].len == len && !strncmp(kinds[i].name, name, len))
+					break;
+			
+			if (i == kindCount)
+			{
+				kinds = (savings*) realloc(kinds, sizeof(savings) * ++kindCount);
+				memset(kinds + i, 0, sizeof(savings));
+				kinds[i].name = name;
+				kinds[i].len = len;
+			}
+			
+			account(file, size, align, used);
+			account(kinds + i, size, align, used);
+			account(&total, size, align, used);
+		}
+	}
+	
+	qsort(files, fileCount, sizeof(savings), compareSavings);
+	qsort(kinds, kindCount, sizeof(savings), compareSavings);
+	
+	fprintf(out, "\n<SAVINGS removed=\"%lu\" kept=\"%lu\" removedPadded=\"%lu\" "
+	        "keptPadded=\"%lu\">\n", total.removed, total.kept,
+	        total.removedPadded, total.keptPadded);
+	
+	for (i = 0; i < kindCount; ++i)
+		dumpSavings(out, "KIND", kinds + i);
+	
+	for (i = 0; i < fileCount; ++i)
+		dumpSavings(out, "FILE", files + i);
+	
+	fprintf(out, "</SAVINGS>\n");
+	
+	free(files);
+	free(kinds);
+}
+
+void deadstripDumpScript(deadstrip* ctx, FILE* out)
+{
+	fprintf(out, "SECTIONS\n{\n\t/DISCARD/ :\n\t{\n");
+	
+	listStart(ctx->objects);
+	while (listNext(ctx->objects))
+	{
+		objectFile* obj = (objectFile*) listGet(ctx->objects);
+		list* unused;
+		
+		/* those don't get linked anyway */
+		if (deadstripIsDead(ctx, obj))
+			continue;
+		
+		unused = deadstripGetUnused(ctx, obj);
+		
+		listStart(unused);
+		while (listNext(unused))
+			fprintf(out, "\t\t\"%s\"(%s)\n", objectFileGetName(obj),
+			        (const char*) listGet(unused));
+		
+		deleteList(unused);
+	}
+	
+	/* the default script must not get to place the sections first */
+	fprintf(out, "\t}\n}\nINSERT BEFORE .text;\n");
+}
+
+int deadstripLoadMap(deadstrip* ctx, const char* path)
+{
+	list *none = newList(), *unknown = newList();
+	hashmap* owner = newHashmap(64);
+	depmap* map = depmapOpen(path);
+	FILE* file = 0;
+	int res = 1;
+	
+	/* the map replaces all objects */
+	deadstripSyncObjects(ctx, none);
+	deleteList(none);
+	
+	if (map)
+	{
+		loadBinary(ctx, map);
+		depmapClose(map);
+	}
+	else if ((file = fopen(path, "r")))
+	{
+		res = loadXml(ctx, file, owner, unknown);
+		fclose(file);
+	}
+	else
+		res = 0;
+	
+	contribute(ctx, ctx->objects, 1);
+	uncolorize(ctx);
+	
+	/* sections whose color still isn't explained, e.g. in a cycle of them,
+	 become referenced by unknown ones as well */
+	listStart(unknown);
+	while (listNext(unknown))
+	{
+		char* key = (char*) listGet(unknown);
+		section* sec = (section*) hashmapGet(ctx->sectionMap, key);
+		
+		if (!(graphGetColorNode(sec->node) & DEADSTRIP_UNKNOWN))
+		{
+			objectFileAddReference((objectFile*) hashmapGet(owner, key),
+			                       SO_UNKNOWN, key);
+			reference(ctx, 0, sec, 1);
+		}
+		
+		free(key);
+	}
+	
+	deleteList(unknown);
+	deleteHashmap(owner);
+	return res;
+}
+
+int deadstripLoadProfile(deadstrip* ctx, FILE* file)
+{
+	char *line = 0, *token, *save;
+	size_t size = 0;
+	int res = 0;
+	
+	listStart(ctx->sections);
+	while (listNext(ctx->sections))
+		((section*) listGet(ctx->sections))->samples = 0;
+	
+	while (getline(&line, &size, file) > 0)
+	{
+		const char* key;
+		char* count;
+		section* sec;
+		
+		token = strtok_r(line, " \t\r\n", &save);
+		
+		/* skip blank lines and comments */
+		if (!token || *token == '#')
+			continue;
+		
+		count = strtok_r(0, " \t\r\n", &save);
+		
+		if (!count)
+		{
+			fprintf(stderr, "ERROR: profile line of %s lacks the count!\n", token);
+			free(line);
+			return -1;
+		}
+		
+		/* symbols no object declares can't be ordered, so they aren't added */
+		key = objectFileKey(token);
+		sec = (section*) hashmapGet(ctx->sectionMap, (key) ? key : token);
+		
+		if (!sec || !sec->decl)
+			continue;
+		
+		sec->samples += strtoul(count, 0, 10);
+		++res;
+	}
+	
+	free(line);
+	return res;
+}
+
+void deadstripDumpOrder(deadstrip* ctx, FILE* out, int mode)
+{
+	size_t count, i;
+	section** sects = getFunctions(ctx, &count);
+	
+	/* hot sections first, the cold ones keep their order */
+	if (mode == DEADSTRIP_ORDER_CLUSTER)
+		cluster(sects, count);
+	else
+		qsort(sects, count, sizeof(section*), compareSamples);
+	
+	fprintf(out, ".text :\n{\n");
+	for (i = 0; i < count; ++i)
+	{
+		fprintf(out, "\t*(%s)\n", graphGetNameNode(sects[i]->node));
+		sects[i]->order = 0;
+	}
+	fprintf(out, "}\n");
+	
+	free(sects);
+}
+
+int deadstripEmitGraph(deadstrip* ctx, FILE* out, int mode,
+                       const char* around, int depth)
+{
+	section *root = 0, **sects;
+	objectFile** objects;
+	size_t count = 0, objectCount, i;
+	
+	if (around)
+	{
+		root = find(ctx, around);
+		
+		if (!root || !root->decl)
+			return 0;
+		
+		markAround(ctx, root, mode, depth);
+	}
+	
+	objects = getObjectArray(ctx, &objectCount);
+	sects = (section**) malloc(sizeof(section*) * (listCount(ctx->sections) + 1));
+	
+	/* number the emitted sections by the first object that declares them */
+	for (i = 0; i < objectCount; ++i)
+	{
+		list* decl = objectFileGetSections(objects[i]);
+		
+		listStart(decl);
+		while (listNext(decl))
+		{
+			section* sec = find(ctx, (const char*) listGet(decl));
+			
+			if (!sec->order && ((root) ? sec->mark : isEmitted(ctx, sec, mode)))
+			{
+				sec->order = i + 1;
+				sects[count++] = sec;
+			}
+		}
+	}
+	
+	if (mode & DEADSTRIP_EMIT_OBJECTS)
+		emitObjects(ctx, out, mode, sects, count, objects, objectCount);
+	else
+		emitSections(ctx, out, mode, sects, count, objects);
+	
+	for (i = 0; i < count; ++i)
+		sects[i]->order = 0;
+	
+	for (i = 0; i < ctx->region.count; ++i)
+		((section*) graphGetDatum(ctx->region.data[i]))->mark = 0;
+	
+	ctx->region.count = 0;
+	free(sects);
+	free(objects);
+	
+	return 1;
+}
@@ -0,0 +1,425 @@
+/***************************************************************************//**
+ * @file deadstrip.h
+ * @author Dorian Weber
+ * @brief Interface of the dependency analysis library.
+ *
+ * All state of an analysis is kept in an opaque context, so independent
+ * analyses may run concurrently, e.g. in different threads of one process.
+ * A single context must not be used by more than one thread at a time.
+ *
+ * The reachability is maintained incrementally: collecting changed objects,
+ * adding or removing seeds and references only touches the affected part of
+ * the dependency graph.
+ *
+ * @sa deadstrip.c, deadstrip.hpp
+ ******************************************************************************/
+
+#ifndef DEADSTRIP_H_INCLUDED
+#define DEADSTRIP_H_INCLUDED
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "list.h"
+#include "objectFile.h"
+#include "stats.h"
+
+/* forward declaration of opaque structure */
+typedef struct s_deadstrip deadstrip;
+
+/**@brief Size of an analysis.
+ */
+typedef struct
+{
+	unsigned long objects; /**< Number of object files. */
+	unsigned long sections; /**< Number of declared sections. */
+	unsigned long relocations; /**< Number of references, counting repeated
+	                                and unknown ones. */
+	unsigned long edges; /**< Number of distinct references between
+	                          sections. */
+} deadstripCounts;
+
+#define DEADSTRIP_SEED     0x00000001UL /**<@brief Default color of seeds. */
+#define DEADSTRIP_UNKNOWN  0x80000000UL /**<@brief Color of sections that are
+                                             referenced by unknown sections. */
+
+/**@brief Creates a new, empty analysis context.
+ * @return pointer to a context
+ */
+extern deadstrip* newDeadstrip();
+
+/**@brief Frees the context together with all its object files and graphs.
+ * @param[in] ctx  analysis context
+ */
+extern void deleteDeadstrip(deadstrip* ctx);
+
+/**@brief Sets the number of threads that classify and format the sections
+ * of the objects for reports.
+ *
+ * @param[in] ctx      analysis context
+ * @param[in] threads  number of threads, \c 0 for one per processor; the
+ *                     default is \c 1
+ */
+extern void deadstripSetThreads(deadstrip* ctx, int threads);
+
+/**@brief Sets the statistics that collecting objects reports its phases to.
+ * @note Parsing the dump and updating the graph are separate phases. Every
+ * parsed object and the share of every thread of a report are traced.
+ *
+ * @param[in] ctx  analysis context
+ * @param[in] st   the statistics, \c NULL to report nothing
+ */
+extern void deadstripSetStats(deadstrip* ctx, stats* st);
+
+/**@brief Returns the statistics of the current run, \c NULL if there are none.
+ */
+extern stats* deadstripGetStats(deadstrip* ctx);
+
+/**@brief Counts the objects, sections and references of the analysis.
+ */
+extern void deadstripGetCounts(deadstrip* ctx, deadstripCounts* dest);
+
+/**@brief Adds an object file to the analysis, unless it's known already.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] name  file name of the object, as passed to objdump
+ * @return the object file, which is owned by the context
+ */
+extern objectFile* deadstripAddObject(deadstrip* ctx, const char* name);
+
+/**@brief Replaces the object files of the analysis.
+ *
+ * Objects that are known already keep their collected sections, unless the
+ * file changed in the meantime (see objectFileRefresh()), others get dropped.
+ *
+ * @param[in] ctx    analysis context
+ * @param[in] names  list of file names
+ * @return number of stale objects, which have to be collected again
+ */
+extern int deadstripSyncObjects(deadstrip* ctx, list* names);
+
+/**@brief Returns the list of object files, in the order they got added.
+ */
+extern list* deadstripGetObjects(deadstrip* ctx);
+
+/**@brief Returns the object file of a given name or \c NULL, if the
+ * analysis doesn't know it.
+ */
+extern objectFile* deadstripGetObject(deadstrip* ctx, const char* name);
+
+/**@brief Collects the sections and relocations of all stale objects and
+ * updates the dependency graph and its colors accordingly.
+ *
+ * Everything that is referenced by unknown sections gets colored with
+ * #DEADSTRIP_UNKNOWN.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] file  output of <tt>objdump -rh</tt> for the stale objects
+ * @return \c 1 on success, \c 0 if the file has an invalid format
+ */
+extern int deadstripCollect(deadstrip* ctx, FILE* file);
+
+/**@brief Collects the sections of all objects and computes the dependencies
+ * between them.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] file  output of <tt>objdump -rh</tt> for all objects
+ * @return \c 1 on success, \c 0 if the file has an invalid format
+ */
+extern int deadstripCompute(deadstrip* ctx, FILE* file);
+
+/**@brief Recursively colorizes the dependency graph starting with seed. Two
+ * colors get mixed using binary OR.
+ *
+ * @param[in] ctx    analysis context
+ * @param[in] seed   decorated name of the function or variable
+ * @param[in] color  the color
+ */
+extern void deadstripColorize(deadstrip* ctx, const char* seed,
+                              unsigned long color);
+
+/**@brief Removes a color from a seed and from everything that isn't reachable
+ * from other seeds of that color anymore.
+ *
+ * @param[in] ctx    analysis context
+ * @param[in] seed   decorated name of the function or variable
+ * @param[in] color  the color
+ */
+extern void deadstripUncolorize(deadstrip* ctx, const char* seed,
+                                unsigned long color);
+
+/**@brief Replaces the seeds of a color, only updating what changed.
+ *
+ * @param[in] ctx    analysis context
+ * @param[in] seeds  list of decorated names
+ * @param[in] color  the color
+ */
+extern void deadstripSyncSeeds(deadstrip* ctx, list* seeds,
+                               unsigned long color);
+
+/**@brief Adds a reference between two sections, as if a relocation table said
+ * so.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] src   key of the referencing section, \c NULL for an unknown one
+ * @param[in] dest  key of the referenced section
+ */
+extern void deadstripConnect(deadstrip* ctx, const char* src,
+                             const char* dest);
+
+/**@brief Removes a reference that got added by deadstripConnect().
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] src   key of the referencing section, \c NULL for an unknown one
+ * @param[in] dest  key of the referenced section
+ */
+extern void deadstripDisconnect(deadstrip* ctx, const char* src,
+                                const char* dest);
+
+/**@brief Recomputes all colors from scratch and compares them with the
+ * incrementally maintained ones.
+ * @note The recomputed colors replace the maintained ones.
+ * @return the number of sections whose colors differed
+ */
+extern unsigned long deadstripVerify(deadstrip* ctx);
+
+/**@brief Returns the color of a section.
+ *
+ * @param[in] ctx  analysis context
+ * @param[in] key  decorated name of the function or variable
+ * @return the color, which is \c 0 for unused or unknown sections
+ */
+extern unsigned long deadstripGetColor(deadstrip* ctx, const char* key);
+
+/**@brief Returns the size of a section in bytes, summed up over all objects
+ * that declare it.
+ *
+ * @param[in] ctx  analysis context
+ * @param[in] key  decorated name of the function or variable
+ */
+extern unsigned long deadstripGetSize(deadstrip* ctx, const char* key);
+
+/**@brief Computes the dominator tree of the used sections and their retained
+ * sizes, i.e. the bytes that would become unused together with a section.
+ *
+ * The tree is rooted in a virtual section that references all seeds and all
+ * sections that are referenced by unknown ones.
+ * @note The results stay valid until the graph or its seeds change.
+ */
+extern void deadstripDominate(deadstrip* ctx);
+
+/**@brief Returns the retained size of a section in bytes.
+ * @pre deadstripDominate() was called.
+ */
+extern unsigned long deadstripGetRetained(deadstrip* ctx, const char* key);
+
+/**@brief Returns the name of the immediate dominator of a section or \c NULL,
+ * if the section is a root or isn't used.
+ * @pre deadstripDominate() was called.
+ */
+extern const char* deadstripGetDominator(deadstrip* ctx, const char* key);
+
+/**@brief Checks, whether nothing of an object needs to be linked.
+ *
+ * That's the case, if none of its sections is used and all sections without
+ * a known prefix are empty or only carry debug information.
+ *
+ * @param[in] ctx  analysis context
+ * @param[in] src  object file
+ * @return \c 1, if the object can be left out of the link, else \c 0
+ */
+extern int deadstripIsDead(deadstrip* ctx, objectFile* src);
+
+/**@brief Folds a section into an identical one, so it doesn't count as used
+ * anymore, although it stays colored.
+ *
+ * @param[in] ctx  analysis context
+ * @param[in] key  decorated name of the folded section
+ * @param[in] rep  decorated name of the representative, \c NULL to unfold
+ */
+extern void deadstripFold(deadstrip* ctx, const char* key, const char* rep);
+
+/**@brief Unfolds all sections.
+ */
+extern void deadstripClearFolds(deadstrip* ctx);
+
+/**@brief Returns the decorated name of the section that replaces a folded one
+ * or \c NULL, if the section isn't folded.
+ */
+extern const char* deadstripGetFold(deadstrip* ctx, const char* key);
+
+/**@brief Returns a list containing all used sections of an object.
+ * @note The caller has to delete the list, but not its content.
+ */
+extern list* deadstripGetUsed(deadstrip* ctx, objectFile* src);
+
+/**@brief Returns a list containing all unused sections of an object.
+ * @note The caller has to delete the list, but not its content.
+ */
+extern list* deadstripGetUnused(deadstrip* ctx, objectFile* src);
+
+/**@brief Returns the shortest chain of references that keeps a section.
+ *
+ * The chain is searched backwards along the predecessors of the section, so
+ * the forward graph doesn't get scanned.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] name  decorated name or full section name
+ * @return list of section names, starting with a seed or a section that is
+ *         referenced by an unknown one and ending with the section itself;
+ *         empty if the section isn't used
+ * @note The caller has to delete the list, but not its content.
+ */
+extern list* deadstripGetChain(deadstrip* ctx, const char* name);
+
+/**@brief Returns the sections that reference a section directly.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] name  decorated name or full section name
+ * @note The caller has to delete the list, but not its content.
+ */
+extern list* deadstripGetReferrers(deadstrip* ctx, const char* name);
+
+/**@brief Dumps the dependency graph XML-like formatted.
+ */
+extern void deadstripDumpMap(deadstrip* ctx, FILE* out);
+
+/**@brief Writes the dependency graph in the binary map format.
+ * @sa depmap.h
+ *
+ * @param[in] ctx  analysis context
+ * @param[in] out  destination, opened in binary mode
+ * @return \c 1 on success, \c 0 if writing failed
+ */
+extern int deadstripWriteMap(deadstrip* ctx, FILE* out);
+
+/**@brief Dumps the used sections in XML-like format.
+ */
+extern void deadstripDumpUsed(deadstrip* ctx, FILE* out);
+
+/**@brief Dumps the unused sections in XML format.
+ */
+extern void deadstripDumpUnused(deadstrip* ctx, FILE* out);
+
+/**@brief Computes the retained sizes and dumps the used sections ordered by
+ * them in XML-like format.
+ * @sa deadstripDominate()
+ */
+extern void deadstripDumpRetained(deadstrip* ctx, FILE* out);
+
+/**@brief Dumps the removed and kept bytes per section kind, per object and
+ * overall in XML-like format, ordered by the removed bytes.
+ * @note Padded sizes are rounded up to the alignment of each section.
+ */
+extern void deadstripDumpSavings(deadstrip* ctx, FILE* out);
+
+/**@brief Dumps a linker script fragment that discards the unused sections.
+ *
+ * The fragment is meant to be passed to ld using \c -T. Its \c INSERT
+ * command merges it into the default script, so the objects don't need to be
+ * rewritten.
+ */
+extern void deadstripDumpScript(deadstrip* ctx, FILE* out);
+
+/**@brief Replaces all objects of the analysis by the ones of a saved
+ * dependency map, so it can be colored and reported on without the objects.
+ *
+ * Both the binary format of deadstripWriteMap() and the XML format of
+ * deadstripDumpMap() are understood. The colors stored in the map are
+ * ignored, except for deriving the references from unknown sections that
+ * the XML format lacks. Seeds have to be given again.
+ * @note The XML format lacks the weights of the references.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] path  file name of the map
+ * @return \c 1 on success, \c 0 if the map can't be read
+ */
+extern int deadstripLoadMap(deadstrip* ctx, const char* path);
+
+/**@brief Reads a sampled profile.
+ *
+ * Every line holds a decorated name or section name and its number of
+ * samples, separated by white space. Lines starting with \c # are ignored,
+ * as are the ones of sections no object declares. Samples of previously read
+ * profiles get replaced.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] file  the profile
+ * @return number of entries of declared sections, \c -1 if the profile has
+ *         an invalid format
+ */
+extern int deadstripLoadProfile(deadstrip* ctx, FILE* file);
+
+#define DEADSTRIP_ORDER_HOT      0 /**<@brief Orders sections by samples. */
+#define DEADSTRIP_ORDER_CLUSTER  1 /**<@brief Clusters callers and callees. */
+
+/**@brief Dumps the used function sections as output section statement for
+ * ld's <tt>--section-ordering-file</tt>.
+ *
+ * #DEADSTRIP_ORDER_HOT puts the sections with profile samples first, ordered
+ * by decreasing number of samples, the cold ones follow in link order.
+ *
+ * #DEADSTRIP_ORDER_CLUSTER merges every section into the cluster of its
+ * heaviest caller, in the order of decreasing hotness, as long as the cluster
+ * stays within a page (C3). The weights of the calls are the numbers of
+ * relocations. Hotness is taken from the profile or, lacking one, from the
+ * weights of the incoming calls. The clusters are ordered by decreasing
+ * density, i.e. hotness per byte.
+ *
+ * @param[in] ctx   analysis context
+ * @param[in] out   destination
+ * @param[in] mode  one of the \c DEADSTRIP_ORDER_* constants
+ */
+extern void deadstripDumpOrder(deadstrip* ctx, FILE* out, int mode);
+
+#define DEADSTRIP_EMIT_DOT      0 /**<@brief Emits the graph in DOT format. */
+#define DEADSTRIP_EMIT_JSON     1 /**<@brief Emits the graph in JSON format. */
+#define DEADSTRIP_EMIT_LIVE     2 /**<@brief Emits the used sections. */
+#define DEADSTRIP_EMIT_DEAD     4 /**<@brief Emits the unused sections. */
+#define DEADSTRIP_EMIT_OBJECTS  8 /**<@brief Collapses every object into a
+                                       single node. */
+
+/**@brief Writes the dependency graph for visualization tools.
+ *
+ * The declared sections become nodes, named by their sections and attributed
+ * to the first object that declares them. Without #DEADSTRIP_EMIT_LIVE or
+ * #DEADSTRIP_EMIT_DEAD, all sections are emitted. References are emitted
+ * between emitted sections only. With #DEADSTRIP_EMIT_OBJECTS, the objects
+ * become nodes and the references between their emitted sections get summed
+ * up.
+ *
+ * The text is written while the graph gets traversed, so the memory
+ * requirements don't depend on the size of the output.
+ *
+ * @param[in] ctx     analysis context
+ * @param[in] out     destination
+ * @param[in] mode    #DEADSTRIP_EMIT_DOT or #DEADSTRIP_EMIT_JSON, combined
+ *                    with the other \c DEADSTRIP_EMIT_* flags
+ * @param[in] around  if not \c NULL, only sections connected to this one are
+ *                    emitted, following references in both directions
+ * @param[in] depth   maximal number of references between those sections and
+ *                    \p around, negative for no limit
+ * @return \c 1 on success, \c 0 if \p around isn't a declared section
+ */
+extern int deadstripEmitGraph(deadstrip* ctx, FILE* out, int mode,
+                              const char* around, int depth);
+
+/**@brief Dumps the chain that keeps a section in XML-like format.
+ * @sa deadstripGetChain()
+ */
+extern void deadstripDumpWhy(deadstrip* ctx, const char* name, FILE* out);
+
+/**@brief Dumps the direct referrers of a section in XML-like format.
+ * @sa deadstripGetReferrers()
+ */
+extern void deadstripDumpReferrers(deadstrip* ctx, const char* name,
+                                   FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,140 @@
+/***************************************************************************//**
+ * @file deadstrip.hpp
+ * @author Dorian Weber
+ * @brief C++ wrapper around the dependency analysis library.
+ * @sa deadstrip.h
+ ******************************************************************************/
+
+#ifndef DEADSTRIP_HPP_INCLUDED
+#define DEADSTRIP_HPP_INCLUDED
+
+#include "deadstrip.h"
+
+#include <cstdio>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ds
+{
+
+/**@brief Owns an analysis context and releases it when going out of scope.
+ */
+class Analysis
+{
+public:
+	/**@brief Creates an empty analysis.
+	 */
+	Analysis() : ctx(newDeadstrip())
+	{
+		if (!ctx)
+			throw std::bad_alloc();
+	}
+	
+	/**@brief Frees the context together with its objects and graphs.
+	 */
+	~Analysis()
+	{
+		if (ctx)
+			deleteDeadstrip(ctx);
+	}
+	
+	Analysis(Analysis&& other) noexcept : ctx(other.ctx)
+	{
+		other.ctx = nullptr;
+	}
+	
+	Analysis& operator=(Analysis&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (ctx)
+				deleteDeadstrip(ctx);
+			ctx = other.ctx;
+			other.ctx = nullptr;
+		}
+		return *this;
+	}
+	
+	Analysis(const Analysis&) = delete;
+	Analysis& operator=(const Analysis&) = delete;
+	
+	/**@brief Adds an object file, in the order objdump reports them.
+	 */
+	void addObject(const std::string& name)
+	{
+		deadstripAddObject(ctx, name.c_str());
+	}
+	
+	/**@brief Computes the dependency graph from the output of objdump.
+	 * @throw std::runtime_error if the dump has an invalid format
+	 */
+	void compute(std::FILE* dump)
+	{
+		if (!deadstripCompute(ctx, dump))
+			throw std::runtime_error("deadstrip: invalid objdump output");
+	}
+	
+	/**@brief Colorizes everything reachable from a seed.
+	 */
+	void colorize(const std::string& seed, unsigned long color = DEADSTRIP_SEED)
+	{
+		deadstripColorize(ctx, seed.c_str(), color);
+	}
+	
+	/**@brief Removes a color from a seed and what only it reached.
+	 */
+	void uncolorize(const std::string& seed,
+	                unsigned long color = DEADSTRIP_SEED)
+	{
+		deadstripUncolorize(ctx, seed.c_str(), color);
+	}
+	
+	/**@brief Returns the color of a section, \c 0 for unused ones.
+	 */
+	unsigned long color(const std::string& key) const
+	{
+		return deadstripGetColor(ctx, key.c_str());
+	}
+	
+	/**@brief Returns the unused section names of an object.
+	 */
+	std::vector<std::string> unused(objectFile* obj) const
+	{
+		return collect(deadstripGetUnused(ctx, obj));
+	}
+	
+	/**@brief Returns the used section names of an object.
+	 */
+	std::vector<std::string> used(objectFile* obj) const
+	{
+		return collect(deadstripGetUsed(ctx, obj));
+	}
+	
+	/**@brief Gives access to the underlying context for the C interface.
+	 */
+	deadstrip* get() const
+	{
+		return ctx;
+	}
+
+private:
+	static std::vector<std::string> collect(list* src)
+	{
+		std::vector<std::string> res;
+		
+		listStart(src);
+		while (listNext(src))
+			res.push_back(static_cast<const char*>(listGet(src)));
+		
+		deleteList(src);
+		return res;
+	}
+	
+	deadstrip* ctx;
+};
+
+}
+
+#endif
@@ -0,0 +1,242 @@
+/***************************************************************************//**
+ * @file depmap.c
+ * @author Dorian Weber
+ * @brief Implementation of the dependency map reader.
+ ******************************************************************************/
+
+#include "depmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* *************************************************************** structures */
+
+/**@brief A mapped map file.
+ */
+struct s_depmap
+{
+	const unsigned char* data; /**< Contents of the file. */
+	size_t size; /**< Size of the file in bytes. */
+	const depmapHeader* header; /**< Header. */
+	const depmapFile* files; /**< File table. */
+	const uint32_t* members; /**< Member table. */
+	const depmapLayout* layouts; /**< Layout table. */
+	const depmapNode* nodes; /**< Node table. */
+	const depmapEdge* edges; /**< Edge table. */
+	const uint32_t* index; /**< Nodes ordered by name. */
+	const char* strings; /**< String table. */
+};
+
+/* ******************************************************** private functions */
+
+/**@brief Checks, whether a table lies within the file and is aligned.
+ */
+static int inside(const depmap* src, uint32_t offset, size_t count,
+                  size_t size)
+{
+	return !(offset & 3) && offset <= src->size
+	       && count <= (src->size - offset) / size;
+}
+
+/**@brief Checks the header and all tables, so queries don't need to.
+ * @return \c 1, if the map is valid, else \c 0
+ */
+static int validate(depmap* src)
+{
+	const depmapHeader* h = (const depmapHeader*) src->data;
+	uint32_t i;
+	
+	if (src->size < sizeof(depmapHeader)
+	    || memcmp(h->magic, DEPMAP_MAGIC, sizeof(h->magic))
+	    || h->version != DEPMAP_VERSION
+	    || !inside(src, h->fileOffset, (size_t) h->files + 1, sizeof(depmapFile))
+	    || !inside(src, h->memberOffset, h->members, sizeof(uint32_t))
+	    || !inside(src, h->layoutOffset, h->members, sizeof(depmapLayout))
+	    || !inside(src, h->nodeOffset, (size_t) h->nodes + 1, sizeof(depmapNode))
+	    || !inside(src, h->edgeOffset, h->edges, sizeof(depmapEdge))
+	    || !inside(src, h->indexOffset, h->nodes, sizeof(uint32_t))
+	    || !inside(src, h->stringOffset, h->strings, 1)
+	    || !h->strings)
+		return 0;
+	
+	src->header = h;
+	src->files = (const depmapFile*) (src->data + h->fileOffset);
+	src->members = (const uint32_t*) (src->data + h->memberOffset);
+	src->layouts = (const depmapLayout*) (src->data + h->layoutOffset);
+	src->nodes = (const depmapNode*) (src->data + h->nodeOffset);
+	src->edges = (const depmapEdge*) (src->data + h->edgeOffset);
+	src->index = (const uint32_t*) (src->data + h->indexOffset);
+	src->strings = (const char*) (src->data + h->stringOffset);
+	
+	/* the last string has to be terminated */
+	if (src->strings[h->strings - 1])
+		return 0;
+	
+	for (i = 0; i <= h->files; ++i)
+		if (src->files[i].name >= h->strings || src->files[i].first > h->members
+		    || (i && src->files[i].first < src->files[i - 1].first))
+			return 0;
+	
+	for (i = 0; i < h->members; ++i)
+		if (src->members[i] >= h->nodes)
+			return 0;
+	
+	for (i = 0; i <= h->nodes; ++i)
+		if (src->nodes[i].name >= h->strings || src->nodes[i].first > h->edges
+		    || (i && src->nodes[i].first < src->nodes[i - 1].first))
+			return 0;
+	
+	for (i = 0; i < h->edges; ++i)
+		if (src->edges[i].target >= h->nodes)
+			return 0;
+	
+	for (i = 0; i < h->nodes; ++i)
+		if (src->index[i] >= h->nodes)
+			return 0;
+	
+	return 1;
+}
+
+/* ******************************************************* exported functions */
+
+depmap* depmapOpen(const char* path)
+{
+	depmap* res = (depmap*) calloc(1, sizeof(depmap));
+
+#ifndef _WIN32
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	void* data;
+	
+	if (fd < 0 || fstat(fd, &st) || !st.st_size)
+	{
+		if (fd >= 0)
+			close(fd);
+		free(res);
+		return 0;
+	}
+	
+	data = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	
+	if (data == MAP_FAILED)
+	{
+		free(res);
+		return 0;
+	}
+	
+	res->data = (const unsigned char*) data;
+	res->size = (size_t) st.st_size;
+#else
+	FILE* file = fopen(path, "rb");
+	unsigned char* data;
+	long size;
+	
+	if (!file || fseek(file, 0, SEEK_END) || (size = ftell(file)) <= 0)
+	{
+		if (file)
+			fclose(file);
+		free(res);
+		return 0;
+	}
+	
+	/* lacking mmap, the file gets read as a whole */
+	data = (unsigned char*) malloc((size_t) size);
+	rewind(file);
+	
+	if (fread(data, 1, (size_t) size, file) != (size_t) size)
+		size = 0;
+	
+	fclose(file);
+	res->data = data;
+	res->size = (size_t) size;
+#endif
+
+	if (!validate(res))
+	{
+		depmapClose(res);
+		return 0;
+	}
+	
+	return res;
+}
+
+void depmapClose(depmap* src)
+{
+#ifndef _WIN32
+	munmap((void*) src->data, src->size);
+#else
+	free((void*) src->data);
+#endif
+	free(src);
+}
+
+const depmapHeader* depmapGetHeader(const depmap* src)
+{
+	return src->header;
+}
+
+const char* depmapGetFile(const depmap* src, uint32_t file)
+{
+	return src->strings + src->files[file].name;
+}
+
+const uint32_t* depmapGetMembers(const depmap* src, uint32_t file,
+                                 uint32_t* count)
+{
+	*count = src->files[file + 1].first - src->files[file].first;
+	return src->members + src->files[file].first;
+}
+
+const depmapLayout* depmapGetLayouts(const depmap* src, uint32_t file,
+                                     uint32_t* count)
+{
+	*count = src->files[file + 1].first - src->files[file].first;
+	return src->layouts + src->files[file].first;
+}
+
+const depmapNode* depmapGetNode(const depmap* src, uint32_t node)
+{
+	return src->nodes + node;
+}
+
+const char* depmapGetName(const depmap* src, uint32_t node)
+{
+	return src->strings + src->nodes[node].name;
+}
+
+const depmapEdge* depmapGetEdges(const depmap* src, uint32_t node,
+                                 uint32_t* count)
+{
+	*count = src->nodes[node + 1].first - src->nodes[node].first;
+	return src->edges + src->nodes[node].first;
+}
+
+long depmapFind(const depmap* src, const char* name)
+{
+	uint32_t lo = 0, hi = src->header->nodes;
+	
+	while (lo < hi)
+	{
+		uint32_t mid = lo + (hi - lo) / 2;
+		int cmp = strcmp(depmapGetName(src, src->index[mid]), name);
+		
+		if (!cmp)
+			return (long) src->index[mid];
+		
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	
+	return -1;
+}
@@ -0,0 +1,160 @@
+/***************************************************************************//**
+ * @file depmap.h
+ * @author Dorian Weber
+ * @brief Binary format of the dependency map and its reader.
+ *
+ * The format is meant to be mapped into memory and queried in place. It
+ * consists of a header followed by these tables, each aligned to four bytes:
+ * \li files: name and first member of every object, plus a sentinel
+ * \li members: node indices of the sections every object declares
+ * \li layouts: size and alignment of every member, i.e. declaration
+ * \li nodes: name, color, size and first edge of every section, plus a
+ *     sentinel
+ * \li edges: referenced node and number of references (CSR layout)
+ * \li index: node indices ordered by name, for binary search
+ * \li strings: zero terminated names, addressed by their offset
+ *
+ * All numbers are stored as 32 bit integers in the byte order of the writer.
+ * Only declared sections become nodes, references to undeclared symbols are
+ * left out like in the XML map.
+ *
+ * @sa depmap.c, deadstripWriteMap()
+ ******************************************************************************/
+
+#ifndef DEPMAP_H_INCLUDED
+#define DEPMAP_H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEPMAP_MAGIC    "DSMP"  /**<@brief Leading bytes of a map file. */
+#define DEPMAP_VERSION  2       /**<@brief Current version of the format. */
+
+/**@brief Header of a map file.
+ */
+typedef struct
+{
+	char magic[4]; /**< Equals #DEPMAP_MAGIC. */
+	uint32_t version; /**< Equals #DEPMAP_VERSION. */
+	uint32_t files; /**< Number of objects. */
+	uint32_t members; /**< Number of members. */
+	uint32_t nodes; /**< Number of sections. */
+	uint32_t edges; /**< Number of distinct references. */
+	uint32_t strings; /**< Size of the string table in bytes. */
+	uint32_t fileOffset; /**< Position of the file table. */
+	uint32_t memberOffset; /**< Position of the member table. */
+	uint32_t layoutOffset; /**< Position of the layout table. */
+	uint32_t nodeOffset; /**< Position of the node table. */
+	uint32_t edgeOffset; /**< Position of the edge table. */
+	uint32_t indexOffset; /**< Position of the name index. */
+	uint32_t stringOffset; /**< Position of the string table. */
+} depmapHeader;
+
+/**@brief Entry of the file table.
+ */
+typedef struct
+{
+	uint32_t name; /**< Offset of the file name. */
+	uint32_t first; /**< First member, the next entry ends the range. */
+} depmapFile;
+
+/**@brief Entry of the layout table, which belongs to the member of the same
+ * index.
+ */
+typedef struct
+{
+	uint32_t size; /**< Size of the declaration in bytes. */
+	uint32_t align; /**< Alignment of the declaration in bytes. */
+} depmapLayout;
+
+/**@brief Entry of the node table.
+ */
+typedef struct
+{
+	uint32_t name; /**< Offset of the section name. */
+	uint32_t color; /**< Color at the time of writing. */
+	uint32_t size; /**< Size in bytes, summed up over all declarations. */
+	uint32_t roots; /**< Number of references from unknown sections. */
+	uint32_t first; /**< First edge, the next entry ends the range. */
+} depmapNode;
+
+/**@brief Entry of the edge table.
+ */
+typedef struct
+{
+	uint32_t target; /**< Index of the referenced node. */
+	uint32_t weight; /**< Number of references. */
+} depmapEdge;
+
+/* forward declaration of opaque structure */
+typedef struct s_depmap depmap;
+
+/**@brief Opens a map file and validates its tables.
+ *
+ * @param[in] path  file name
+ * @return pointer to the map or \c NULL, if the file can't be read or isn't
+ *         a valid map
+ */
+extern depmap* depmapOpen(const char* path);
+
+/**@brief Unmaps the file.
+ */
+extern void depmapClose(depmap* src);
+
+/**@brief Returns the header of the map.
+ */
+extern const depmapHeader* depmapGetHeader(const depmap* src);
+
+/**@brief Returns the name of an object.
+ */
+extern const char* depmapGetFile(const depmap* src, uint32_t file);
+
+/**@brief Returns the node indices of the sections an object declares.
+ *
+ * @param[in]  src    the map
+ * @param[in]  file   index of the object
+ * @param[out] count  number of members
+ */
+extern const uint32_t* depmapGetMembers(const depmap* src, uint32_t file,
+                                        uint32_t* count);
+
+/**@brief Returns the sizes and alignments of the sections an object
+ * declares, in the order of depmapGetMembers().
+ *
+ * @param[in]  src    the map
+ * @param[in]  file   index of the object
+ * @param[out] count  number of members
+ */
+extern const depmapLayout* depmapGetLayouts(const depmap* src, uint32_t file,
+                                            uint32_t* count);
+
+/**@brief Returns the entry of a node.
+ */
+extern const depmapNode* depmapGetNode(const depmap* src, uint32_t node);
+
+/**@brief Returns the name of a node.
+ */
+extern const char* depmapGetName(const depmap* src, uint32_t node);
+
+/**@brief Returns the references of a node.
+ *
+ * @param[in]  src    the map
+ * @param[in]  node   index of the node
+ * @param[out] count  number of edges
+ */
+extern const depmapEdge* depmapGetEdges(const depmap* src, uint32_t node,
+                                        uint32_t* count);
+
+/**@brief Searches a node by its section name.
+ * @return index of the node or \c -1, if there is none
+ */
+extern long depmapFind(const depmap* src, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
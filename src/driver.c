@@ -0,0 +1,1023 @@
+/***************************************************************************//**
+ * @file driver.c
+ * @author Dorian Weber
+ * @brief Contains the flow control of a single deadstrip run.
+ ******************************************************************************/
+
+#include "driver.h"
+#include "icf.h"
+#include "list.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* modify those, if you're migrating onto a new system */
+#define SO_LINKER   "i686-w64-mingw32-ld"         /**<@brief The default linker. */
+#define SO_DUMPER   "i686-w64-mingw32-objdump"    /**<@brief The object file dumper. */
+#define SO_DPARAM   "-rh"        /**<@brief Parameters for the dumper. */
+#define SO_CPARAM   "-s"         /**<@brief Dumper parameter for contents. */
+#define SO_DFILE    ".-"         /**<@brief Temporary file for the dumper. */
+#define SO_REMOVER  "i686-w64-mingw32-objcopy"    /**<@brief Object copy tool. */
+#define SO_RRMV     "-R"         /**<@brief Parameter to remove sections. */
+#define SO_PIPE     ">"          /**<@brief Pipe symbol. */
+#define SO_SCRIPT   "-T"         /**<@brief Linker parameter to pass a script. */
+#define SO_DEFSYM   "--defsym"   /**<@brief Linker parameter to alias a symbol. */
+#define SO_SYMBOL   "_"          /**<@brief Prefix of C symbols. */
+
+#ifdef _WIN32
+#define SO_QUOTE    '"'          /**<@brief Quotes an argument for the shell. */
+#define SO_ESCAPE   "\\"         /**<@brief Escapes a quote within an argument. */
+#else
+#define SO_QUOTE    '\''         /**<@brief Quotes an argument for the shell. */
+#define SO_ESCAPE   "'\\'"       /**<@brief Escapes a quote within an argument. */
+#endif
+
+static const char* hlp = "Usage: deadstrip [options] file...\n"
+	"Options:\n"
+	"  --help                display this HELP\n"
+	"  --dcmd                Dumps the ComManD line\n"
+	"  --ddis                Dumps DIScarted sections\n"
+	"  --duse                Dumps USEd sections\n"
+	"  --dmap                Dump the dependency MAP\n"
+	"  --bmap <filename>     write the dependency map in Binary format\n"
+	"    > query it using dsmap\n"
+	"  --emit-dot <filename> EMIT the dependency graph in DOT format\n"
+	"  --emit-json <filename>\n"
+	"                        EMIT the dependency graph in JSON format\n"
+	"  --emit-live           emit only the LIVE, i.e. used sections\n"
+	"  --emit-dead           emit only the DEAD, i.e. unused sections\n"
+	"  --emit-around <item>  emit only the sections connected to an item\n"
+	"  --emit-depth <n>      emit sections at most n references AROUND the item\n"
+	"  --emit-objects        emit every OBJECT as a single node\n"
+	"  --from-map <filename> analyze a saved dependency MAP instead of objects\n"
+	"    > nothing gets removed or linked, both map formats are understood\n"
+	"  --dret                Dump the RETained size of every used section\n"
+	"  --dsav                Dump the SAVed bytes per object and kind\n"
+	"  --linker <filename>   use alternative LINKER (default: "SO_LINKER")\n"
+	"  --dumper <filename>   use alternative DUMPER (default: "SO_DUMPER")\n"
+	"  --remover <filename>  use alternative REMOVER (default: "SO_REMOVER")\n"
+	"  --dnrm                Do Not ReMove any sections\n"
+	"  --stats               dump time and memory STATisticS per phase\n"
+	"  --stats-json <filename>\n"
+	"                        write the STATisticS in JSON format\n"
+	"  --trace <filename>    write a TRACE of phases, objects and subprocesses\n"
+	"    > open it in Perfetto or chrome://tracing\n"
+	"  --profile <filename>  read a PROFILE of \"symbol count\" lines\n"
+	"  --order <filename>    write an ORDERing file, hot sections come first\n"
+	"    > pass it to the linker using --section-ordering-file\n"
+	"  --cluster             CLUSTER callers and callees in the ordering file\n"
+	"  --icf                 report Identical Code that could be Folded\n"
+	"  --fold                FOLD identical code into one section\n"
+	"    > the folded functions lose their distinct addresses\n"
+	"  --script <filename>   discard sections by a linker SCRIPT fragment\n"
+	"    > the objects stay untouched, the linker gets passed the script\n"
+	"  --verify              VERIFY the incrementally computed colors\n"
+	"  --threads <n>         number of THREADS for reports and --icf\n"
+	"    > the default of 0 uses one per processor\n"
+	"  --save <item>         SAVE an item and its dependencies\n"
+	"    > just pass the decorated variable/function name, not the section\n"
+	"    > the main function gets saved by default\n"
+	"  --why <item>          explain WHY an item is kept\n"
+	"  --who-uses <item>     list the sections that reference an item\n"
+	"  --serve <socket>      keep analyses in memory and SERVE requests\n"
+	"  --client <socket> <command> [argument...]\n"
+	"                        send a request to a running server\n"
+	"    > commands are link, query, drop and stop\n"
+	"  --watch [option...] file...\n"
+	"                        relink whenever one of the objects changes\n"
+	"\n"
+	"Version 1.1\n"
+	"Last compiled on "__DATE__".\n";
+
+#define SO_DUMP_CMDLN      1
+#define SO_DUMP_DISCARTED  2
+#define SO_DUMP_USED       4
+#define SO_OBJECTS         8
+#define SO_HELP           16
+#define SO_DUMP_MAP       32
+#define SO_DNRM           64
+#define SO_COLLECT       128
+#define SO_VERIFY        256
+#define SO_DUMP_RETAINED 512
+#define SO_DUMP_SAVINGS 1024
+#define SO_CLUSTER      2048
+#define SO_ICF          4096
+#define SO_FOLD         8192
+#define SO_EMIT_LIVE   16384
+#define SO_EMIT_DEAD   32768
+#define SO_EMIT_OBJECTS 65536
+#define SO_STATS      131072
+
+/* SC == StreamCopy, ~StarCraft */
+#define SO_SC(tar, txt) \
+{\
+  const char* data = txt;\
+  while ((*tar = *data++))\
+    ++tar;\
+}
+
+/**@brief Returns the length of an argument quoted for the shell.
+ */
+static unsigned long quotedLen(const char* src)
+{
+	unsigned long res = strlen(src) + 2;
+	
+	for (; *src; ++src)
+	{
+		if (*src == SO_QUOTE)
+			res += sizeof(SO_ESCAPE) - 1;
+#ifdef _WIN32
+		
+		/* at most, every backslash gets doubled */
+		if (*src == '\\')
+			++res;
+#endif
+	}
+	
+	return res;
+}
+
+/**@brief Copies an argument quoted for the shell, so section names like
+ * .text$foo don't get expanded.
+ * @return the end of the copy
+ */
+static char* quote(char* tar, const char* src)
+{
+	*tar++ = SO_QUOTE;
+	
+	for (; *src; ++src)
+	{
+#ifdef _WIN32
+		/* backslashes in front of a quote escape it, so they get doubled */
+		size_t n = strspn(src, "\\");
+		
+		if (n && (!src[n] || src[n] == SO_QUOTE))
+		{
+			memset(tar, '\\', 2 * n);
+			tar += 2 * n;
+			src += n;
+			
+			if (!*src)
+				break;
+		}
+		
+#endif
+		/* sh closes, escapes and reopens the quote, Windows escapes it */
+		if (*src == SO_QUOTE)
+			SO_SC(tar, SO_ESCAPE);
+		
+		*tar++ = *src;
+	}
+	
+	*tar++ = SO_QUOTE;
+	*tar = 0;
+	
+	return tar;
+}
+
+/**@brief Runs a command and copies its output to the stream.
+ * @param[in] cmdLn  command line
+ * @param[in] out    destination of the output
+ * @param[in] st     statistics that count the subprocess
+ * @return exit status of the command
+ */
+static int run(const char* cmdLn, FILE* out, stats* st)
+{
+	char buffer[256], name[64];
+	double begin = statsTime();
+	FILE* pipe;
+	int res;
+	
+	statsAdd(st, "subprocesses", 1);
+	
+	/* the span is named by the program */
+	if (sscanf(cmdLn, "%63s", name) != 1)
+		*name = 0;
+	
+	/* the output doesn't need to be redirected */
+	if (out == stdout)
+	{
+		res = system(cmdLn);
+		statsSpan(st, "subprocess", name, cmdLn, begin);
+		return res;
+	}
+	
+	{
+		char* redirect = (char*) malloc(strlen(cmdLn) + sizeof(" 2>&1"));
+		
+		strcpy(redirect, cmdLn);
+		strcat(redirect, " 2>&1");
+		pipe = popen(redirect, "r");
+		free(redirect);
+	}
+	
+	if (!pipe)
+		return -1;
+	
+	while ((res = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+		fwrite(buffer, 1, res, out);
+	
+	res = pclose(pipe);
+	statsSpan(st, "subprocess", name, cmdLn, begin);
+	
+	return res;
+}
+
+/**@brief Dumps the contents of the linked objects and finds identical
+ * function sections.
+ * @return the result, \c NULL on failure
+ */
+static icf* findIdentical(deadstrip* ds, const char* dumper, int threads,
+                          stats* st, FILE* out, FILE* err)
+{
+	list* objects = deadstripGetObjects(ds);
+	unsigned long len = strlen(dumper)
+	                    + sizeof(" " SO_CPARAM " " SO_PIPE SO_DFILE);
+	char *cmdLn, *start;
+	FILE* dump;
+	icf* res;
+	
+	listStart(objects);
+	while (listNext(objects))
+		len += quotedLen(objectFileGetName((objectFile*) listGet(objects))) + 1;
+	
+	start = cmdLn = (char*) malloc(len);
+	SO_SC(cmdLn, dumper);
+	SO_SC(cmdLn, " " SO_CPARAM " ");
+	
+	listStart(objects);
+	while (listNext(objects))
+	{
+		objectFile* obj = (objectFile*) listGet(objects);
+		
+		/* dead objects don't have used sections */
+		if (!deadstripIsDead(ds, obj))
+		{
+			cmdLn = quote(cmdLn, objectFileGetName(obj));
+			SO_SC(cmdLn, " ");
+		}
+	}
+	
+	SO_SC(cmdLn, SO_PIPE SO_DFILE);
+	run(start, out, st);
+	free(start);
+	
+	dump = fopen(SO_DFILE, "r");
+	
+	if (!dump)
+	{
+		fprintf(err, "ERROR: Couldn't search identical code, because "
+			"dumpfile could not be opened.\n");
+		return 0;
+	}
+	
+	res = newIcf(ds);
+	icfCollect(res, dump);
+	icfCompute(res, threads);
+	
+	fclose(dump);
+	remove(SO_DFILE);
+	
+	return res;
+}
+
+/**@brief Writes the dependency graph into a file.
+ */
+static void emit(deadstrip* ds, const char* path, int mode, const char* around,
+                 int depth, FILE* err)
+{
+	FILE* file = fopen(path, "w");
+	
+	if (!file)
+	{
+		fprintf(err, "ERROR: Couldn't write graph file %s.\n", path);
+		return;
+	}
+	
+	if (!deadstripEmitGraph(ds, file, mode, around, depth))
+		fprintf(err, "ERROR: Section %s is unknown.\n", around);
+	
+	fclose(file);
+}
+
+/* ******************************************************* exported functions */
+
+int driverRun(deadstrip* ds, int argc, const char* argv[], FILE* out, FILE* err)
+{
+	const char *linker = SO_LINKER, *dumper = SO_DUMPER, *remover = SO_REMOVER,
+	           *script = 0, *profile = 0, *order = 0, *bmap = 0, *fromMap = 0,
+	           *dot = 0, *json = 0, *around = 0, *statsJson = 0, *trace = 0;
+	char** largs = (char**) malloc(sizeof(char*) * argc);
+	int i = argc, li = 0, llen = strlen(linker) + 2, olen = 0, len,
+	    threads = 0, depth = -1, mode = 0;
+	unsigned long flags = 0;
+	list *lObject = newList(), *lSeed = newList(), *lWhy = newList(),
+	     *lUsers = newList(), *lDefsym = newList();
+	icf* identical = 0;
+	stats* st = newStats();
+	
+	
+	/* add main procedure as seed for the graph coloring algorithm */
+	listAdd(lSeed, "main");
+	
+	
+	/* extract infos */
+	while (--i > 0)
+	{
+		++argv;
+		if (**argv == '-')
+		{
+			flags &= ~SO_COLLECT;
+			if (argv[0][1] == '-')
+			{
+				if (!strcmp(*argv, "--save"))
+				{
+					++argv;
+					
+					if (--i)
+						listAdd(lSeed, *argv);
+					
+					continue;
+				}
+				else if (!strcmp(*argv, "--why"))
+				{
+					++argv;
+					
+					if (--i)
+						listAdd(lWhy, *argv);
+					
+					continue;
+				}
+				else if (!strcmp(*argv, "--who-uses"))
+				{
+					++argv;
+					
+					if (--i)
+						listAdd(lUsers, *argv);
+					
+					continue;
+				}
+				else if (!strcmp(*argv, "--help"))
+				{
+					flags |= SO_HELP;
+					continue;
+				}
+				else if (!strcmp(*argv, "--dcmd"))
+				{
+					flags |= SO_DUMP_CMDLN;
+					continue;
+				}
+				else if (!strcmp(*argv, "--ddis"))
+				{
+					flags |= SO_DUMP_DISCARTED;
+					continue;
+				}
+				else if (!strcmp(*argv, "--duse"))
+				{
+					flags |= SO_DUMP_USED;
+					continue;
+				}
+				else if (!strcmp(*argv, "--dmap"))
+				{
+					flags |= SO_DUMP_MAP;
+					continue;
+				}
+				else if (!strcmp(*argv, "--dret"))
+				{
+					flags |= SO_DUMP_RETAINED;
+					continue;
+				}
+				else if (!strcmp(*argv, "--dsav"))
+				{
+					flags |= SO_DUMP_SAVINGS;
+					continue;
+				}
+				else if (!strcmp(*argv, "--linker"))
+				{
+					++argv;
+					if (--i)
+					{
+						llen += strlen(*argv) - strlen(linker);
+						linker = *argv;
+					}
+					continue;
+				}
+				else if (!strcmp(*argv, "--dumper"))
+				{
+					++argv;
+					if (--i)
+						dumper = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--remover"))
+				{
+					++argv;
+					if (--i)
+						remover = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--script"))
+				{
+					++argv;
+					if (--i)
+						script = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--profile"))
+				{
+					++argv;
+					if (--i)
+						profile = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--bmap"))
+				{
+					++argv;
+					if (--i)
+						bmap = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-dot"))
+				{
+					++argv;
+					if (--i)
+						dot = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-json"))
+				{
+					++argv;
+					if (--i)
+						json = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-around"))
+				{
+					++argv;
+					if (--i)
+						around = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-depth"))
+				{
+					++argv;
+					if (--i)
+						depth = atoi(*argv);
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-live"))
+				{
+					flags |= SO_EMIT_LIVE;
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-dead"))
+				{
+					flags |= SO_EMIT_DEAD;
+					continue;
+				}
+				else if (!strcmp(*argv, "--emit-objects"))
+				{
+					flags |= SO_EMIT_OBJECTS;
+					continue;
+				}
+				else if (!strcmp(*argv, "--threads"))
+				{
+					++argv;
+					if (--i)
+						threads = atoi(*argv);
+					continue;
+				}
+				else if (!strcmp(*argv, "--from-map"))
+				{
+					++argv;
+					if (--i)
+					{
+						fromMap = *argv;
+						flags |= SO_OBJECTS;
+					}
+					continue;
+				}
+				else if (!strcmp(*argv, "--order"))
+				{
+					++argv;
+					if (--i)
+						order = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--cluster"))
+				{
+					flags |= SO_CLUSTER;
+					continue;
+				}
+				else if (!strcmp(*argv, "--icf"))
+				{
+					flags |= SO_ICF;
+					continue;
+				}
+				else if (!strcmp(*argv, "--fold"))
+				{
+					flags |= SO_ICF | SO_FOLD;
+					continue;
+				}
+				else if (!strcmp(*argv, "--stats"))
+				{
+					flags |= SO_STATS;
+					continue;
+				}
+				else if (!strcmp(*argv, "--stats-json"))
+				{
+					++argv;
+					if (--i)
+						statsJson = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--trace"))
+				{
+					++argv;
+					if (--i)
+						trace = *argv;
+					continue;
+				}
+				else if (!strcmp(*argv, "--dnrm"))
+				{
+					flags |= SO_DNRM;
+					continue;
+				}
+				else if (!strcmp(*argv, "--verify"))
+				{
+					flags |= SO_VERIFY;
+					continue;
+				}
+			}
+			else if (!strncmp(*argv, "-o", sizeof("-o") - 1))
+			{
+				flags |= SO_COLLECT | SO_OBJECTS;
+				
+				
+				/* command line looks like -o Executable */
+				if (!argv[0][sizeof("-o") - 1])
+				{
+					/* collect linker arguments */
+					llen += quotedLen(*argv) + 1;
+					largs[li++] = (char*) *argv;
+					continue;
+				}
+			}
+		}
+
+		len = quotedLen(*argv) + 1;
+		
+		
+		/* collect objectfiles */
+		if (flags & SO_COLLECT)
+		{
+			listAdd(lObject, *argv);
+			olen += len;
+		}
+		
+		/* collect linker arguments */
+		llen += len;
+		largs[li++] = (char*) *argv;
+	}
+
+	argv -= argc - 1;
+	largs[li] = 0;
+	
+	if (flags & SO_HELP)
+		fprintf(out, "%s\n", hlp);
+	
+	if (trace && !statsTrace(st, trace))
+		fprintf(err, "ERROR: Couldn't write trace %s.\n", trace);
+	
+	
+	/* perform analysis */
+	if (flags & SO_OBJECTS)
+	{
+		deadstripSetThreads(ds, threads);
+		deadstripSetStats(ds, st);
+		
+		if (!fromMap)
+		{
+			/* the first object file is always the exe, so we skip that */
+			listStart(lObject);
+			listNext(lObject);
+			olen -= quotedLen((const char*) listGet(lObject)) + 1;
+			listRemove(lObject);
+			
+			
+			/* command is: link an executable using no object files */
+			if (listIsEmpty(lObject))
+			{
+				fprintf(err, "ERROR: You can't link an executable without "
+					"providing object files.");
+				free(largs);
+				deleteList(lObject);
+				deleteList(lSeed);
+				deadstripSetStats(ds, 0);
+				deleteStats(st);
+				return -1;
+			}
+		}
+		
+		/* replay a saved map instead of dumping the objects */
+		if (fromMap)
+		{
+			statsPhase(st, "load");
+			
+			if (!deadstripLoadMap(ds, fromMap))
+				fprintf(err, "ERROR: Couldn't read dependency map %s.\n", fromMap);
+		}
+		
+		/* collect interesting sections, but only of objects that changed since
+		 * the context saw them the last time */
+		else if (deadstripSyncObjects(ds, lObject))
+		{
+			char *cmdLn = (char*) malloc(strlen(dumper) + olen
+			                             + sizeof(" " SO_DPARAM " " SO_PIPE SO_DFILE)),
+			     *start = cmdLn;
+			list* objects = deadstripGetObjects(ds);
+			
+			/* generate objdump */
+			statsPhase(st, "dump");
+			SO_SC(cmdLn, dumper);
+			SO_SC(cmdLn, " " SO_DPARAM " ");
+			
+			listStart(objects);
+			while (listNext(objects))
+			{
+				objectFile* obj = (objectFile*) listGet(objects);
+				
+				if (objectFileIsStale(obj))
+				{
+					cmdLn = quote(cmdLn, objectFileGetName(obj));
+					SO_SC(cmdLn, " ");
+				}
+			}
+			
+			SO_SC(cmdLn, SO_PIPE SO_DFILE);
+			
+			run(start, out, st);
+			free(start);
+			
+			
+			/* process */
+			{
+				FILE* objDump = fopen(SO_DFILE, "r");
+				
+				if (objDump)
+				{
+					deadstripCollect(ds, objDump);
+					
+					fclose(objDump);
+					remove(SO_DFILE);
+				}
+				else
+					fprintf(err, "ERROR: Couldn't compute dependency graph, because "
+						"dumpfile could not be opened.\n");
+			}
+		}
+		
+		/* colorize all seeds, the ones of the last run only get updated */
+		statsPhase(st, "colorize");
+		deadstripSyncSeeds(ds, lSeed, DEADSTRIP_SEED);
+		
+		/* compare against a computation from scratch */
+		if (flags & SO_VERIFY)
+		{
+			unsigned long diff;
+			
+			statsPhase(st, "verify");
+			diff = deadstripVerify(ds);
+			
+			if (diff)
+				fprintf(err, "ERROR: %lu sections were colored inconsistently!\n",
+				        diff);
+		}
+		
+		/* search identical code */
+		deadstripClearFolds(ds);
+		
+		/* the contents can only be read from the objects */
+		if ((flags & SO_ICF) && !fromMap)
+		{
+			statsPhase(st, "icf");
+			identical = findIdentical(ds, dumper, threads, st, out, err);
+		}
+		
+		if (identical && (flags & SO_FOLD))
+			icfFold(identical);
+		
+		/* the linker aliases the symbols of the folded sections */
+		if (identical && (flags & SO_FOLD) && !(flags & SO_DNRM))
+		{
+			list* objects = deadstripGetObjects(ds);
+			
+			listStart(objects);
+			while (listNext(objects))
+			{
+				list* sects = objectFileGetSections((objectFile*) listGet(objects));
+				
+				listStart(sects);
+				while (listNext(sects))
+				{
+					const char* key = objectFileKey((const char*) listGet(sects));
+					const char* rep = deadstripGetFold(ds, key);
+					char* arg;
+					
+					if (!rep)
+						continue;
+					
+					arg = (char*) malloc(sizeof(SO_DEFSYM " " SO_SYMBOL "=" SO_SYMBOL)
+					                     + strlen(key) + strlen(rep));
+					sprintf(arg, SO_DEFSYM " " SO_SYMBOL "%s=" SO_SYMBOL "%s", key, rep);
+					
+					listAdd(lDefsym, arg);
+					llen += strlen(arg) + 1;
+				}
+			}
+		}
+		
+		/* read the profile */
+		statsPhase(st, "output");
+		
+		if (profile)
+		{
+			FILE* file = fopen(profile, "r");
+			
+			if (file)
+			{
+				deadstripLoadProfile(ds, file);
+				fclose(file);
+			}
+			else
+				fprintf(err, "ERROR: Couldn't read profile %s.\n", profile);
+		}
+		
+		/* order the sections */
+		if (order)
+		{
+			FILE* file = fopen(order, "w");
+			
+			if (file)
+			{
+				deadstripDumpOrder(ds, file, (flags & SO_CLUSTER)
+				                   ? DEADSTRIP_ORDER_CLUSTER : DEADSTRIP_ORDER_HOT);
+				fclose(file);
+			}
+			else
+				fprintf(err, "ERROR: Couldn't write ordering file %s.\n", order);
+		}
+		
+		/* write the binary map */
+		if (bmap)
+		{
+			FILE* file = fopen(bmap, "wb");
+			
+			if (!file || !deadstripWriteMap(ds, file))
+				fprintf(err, "ERROR: Couldn't write map file %s.\n", bmap);
+			
+			if (file)
+				fclose(file);
+		}
+		
+		/* write the graph for visualization */
+		if (dot || json)
+		{
+			mode = ((flags & SO_EMIT_LIVE) ? DEADSTRIP_EMIT_LIVE : 0)
+			       | ((flags & SO_EMIT_DEAD) ? DEADSTRIP_EMIT_DEAD : 0)
+			       | ((flags & SO_EMIT_OBJECTS) ? DEADSTRIP_EMIT_OBJECTS : 0);
+			
+			if (dot)
+				emit(ds, dot, mode | DEADSTRIP_EMIT_DOT, around, depth, err);
+			
+			if (json)
+				emit(ds, json, mode | DEADSTRIP_EMIT_JSON, around, depth, err);
+		}
+		
+		/* let the linker discard unused sections */
+		if (script && !(flags & SO_DNRM))
+		{
+			FILE* file = fopen(script, "w");
+			
+			if (file)
+			{
+				deadstripDumpScript(ds, file);
+				fclose(file);
+				
+				llen += sizeof(SO_SCRIPT " ") + quotedLen(script);
+			}
+			else
+			{
+				fprintf(err, "ERROR: Couldn't write linker script %s.\n", script);
+				script = 0;
+			}
+		}
+		
+		/* now remove unused sections */
+		else if (!(flags & SO_DNRM) && !fromMap)
+		{
+			char *cmdLn = 0, *start;
+			list* objects = deadstripGetObjects(ds);
+			
+			statsPhase(st, "remove");
+			
+			listStart(objects);
+			while (listNext(objects))
+			{
+				objectFile* obj = (objectFile*) listGet(objects);
+				const char* file = objectFileGetName(obj);
+				unsigned long size = strlen(remover) + sizeof(" ") + quotedLen(file);
+				list* nonDepends;
+				
+				/* dead objects don't get linked at all */
+				if (deadstripIsDead(ds, obj))
+					continue;
+				
+				nonDepends = deadstripGetUnused(ds, obj);
+				
+				if (listIsEmpty(nonDepends))
+				{
+					deleteList(nonDepends);
+					continue;
+				}
+				
+				/* it's safer to calculate the size first */
+				listStart(nonDepends);
+				while (listNext(nonDepends))
+					size += sizeof(SO_RRMV " ")
+					        + quotedLen((char*) listGet(nonDepends));
+				
+				cmdLn = (char*) realloc(cmdLn, size);
+				start = cmdLn;
+				SO_SC(cmdLn, remover);
+				SO_SC(cmdLn, " ");
+
+				listStart(nonDepends);
+				while (listNext(nonDepends))
+				{
+					SO_SC(cmdLn, SO_RRMV " ");
+					cmdLn = quote(cmdLn, (char*) listGet(nonDepends));
+					SO_SC(cmdLn, " ");
+				}
+				quote(cmdLn, file);
+				cmdLn = start;
+				
+				run(cmdLn, out, st);
+				deleteList(nonDepends);
+				
+				/* the removed sections are still known, so don't collect again */
+				objectFileTouch(obj);
+			}
+			
+			free(cmdLn);
+		}
+		
+		
+		/* call linker */
+		if (!fromMap)
+		{
+			char *cmdLn = (char*) malloc(sizeof(char) * llen), *start = cmdLn;
+			
+			statsPhase(st, "link");
+			SO_SC(cmdLn, linker);
+			SO_SC(cmdLn, " ");
+
+			i = 0;
+			while (i < li)
+			{
+				objectFile* obj = deadstripGetObject(ds, largs[i]);
+				
+				/* leave out the objects that contribute nothing, unless the
+				 inputs mustn't be touched */
+				if ((flags & SO_DNRM) || !obj || !deadstripIsDead(ds, obj))
+				{
+					cmdLn = quote(cmdLn, largs[i]);
+					SO_SC(cmdLn, " ");
+				}
+				++i;
+			}
+			
+			listStart(lDefsym);
+			while (listNext(lDefsym))
+			{
+				SO_SC(cmdLn, (const char*) listGet(lDefsym));
+				SO_SC(cmdLn, " ");
+			}
+			
+			if (script && !(flags & SO_DNRM))
+			{
+				SO_SC(cmdLn, SO_SCRIPT " ");
+				quote(cmdLn, script);
+			}
+			
+			run(start, out, st);
+			free(start);
+		}
+	}
+	else if (!(flags & SO_HELP))
+		fprintf(out, "%s\n", hlp);
+	
+	
+	/* dump command line */
+	if (flags & SO_DUMP_CMDLN)
+	{
+		fprintf(out, "\nCOMMAND LINE:\n%s ", *argv++);
+		while (--argc)
+			fprintf(out, "%s ", *argv++);
+		fprintf(out, "\n");
+	}
+	
+	if (flags & SO_OBJECTS)
+	{
+		statsPhase(st, "reports");
+		
+		/* dump generated dependency graph */
+		if (flags & SO_DUMP_MAP)
+			deadstripDumpMap(ds, out);
+		
+		
+		/* dump used sections */
+		if (flags & SO_DUMP_USED)
+			deadstripDumpUsed(ds, out);
+		
+		
+		/* dump unused sections */
+		if (flags & SO_DUMP_DISCARTED)
+			deadstripDumpUnused(ds, out);
+		
+		
+		/* dump retained sizes */
+		if (flags & SO_DUMP_RETAINED)
+			deadstripDumpRetained(ds, out);
+		
+		
+		/* dump saved bytes */
+		if (flags & SO_DUMP_SAVINGS)
+			deadstripDumpSavings(ds, out);
+		
+		
+		/* explain the requested sections */
+		listStart(lWhy);
+		while (listNext(lWhy))
+			deadstripDumpWhy(ds, (const char*) listGet(lWhy), out);
+		
+		listStart(lUsers);
+		while (listNext(lUsers))
+			deadstripDumpReferrers(ds, (const char*) listGet(lUsers), out);
+		
+		
+		/* dump identical code */
+		if (identical)
+			icfDump(identical, out);
+		
+		
+		/* dump the statistics */
+		statsPhase(st, 0);
+		deadstripSetStats(ds, 0);
+		
+		if ((flags & SO_STATS) || statsJson)
+		{
+			deadstripCounts counts;
+			
+			deadstripGetCounts(ds, &counts);
+			statsAdd(st, "objects", counts.objects);
+			statsAdd(st, "sections", counts.sections);
+			statsAdd(st, "relocations", counts.relocations);
+			statsAdd(st, "edges", counts.edges);
+		}
+		
+		if (flags & SO_STATS)
+			statsDump(st, out, 0);
+		
+		if (statsJson)
+		{
+			FILE* file = fopen(statsJson, "w");
+			
+			if (file)
+			{
+				statsDump(st, file, 1);
+				fclose(file);
+			}
+			else
+				fprintf(err, "ERROR: Couldn't write statistics %s.\n", statsJson);
+		}
+	}
+	
+	/* just to be clean, although not really necessary */
+	free(largs);
+	deleteList(lObject);
+	deleteList(lSeed);
+	deleteList(lWhy);
+	deleteList(lUsers);
+	
+	listStart(lDefsym);
+	while (listNext(lDefsym))
+		free(listGet(lDefsym));
+	deleteList(lDefsym);
+	
+	if (identical)
+		deleteIcf(identical);
+	
+	deleteStats(st);
+	return 0;
+}
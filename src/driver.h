@@ -0,0 +1,30 @@
+/***************************************************************************//**
+ * @file driver.h
+ * @author Dorian Weber
+ * @brief Interface of the flow control of a single deadstrip run.
+ * @sa driver.c
+ ******************************************************************************/
+
+#ifndef DRIVER_H_INCLUDED
+#define DRIVER_H_INCLUDED
+
+#include <stdio.h>
+#include "deadstrip.h"
+
+/**@brief Analyzes the objects of a command line, removes their unused
+ * sections and calls the linker.
+ * 
+ * Objects that the context already knows and that didn't change since then
+ * aren't dumped again.
+ * 
+ * @param[in] ds    analysis context
+ * @param[in] argc  number of arguments
+ * @param[in] argv  command line, including the program name
+ * @param[in] out   receives the dumps and the output of the tools
+ * @param[in] err   receives error messages
+ * @return \c 0 on success, \c -1 otherwise
+ */
+extern int driverRun(deadstrip* ds, int argc, const char* argv[], FILE* out,
+                     FILE* err);
+
+#endif
@@ -0,0 +1,170 @@
+/***************************************************************************//**
+ * @file dsmap.c
+ * @author Dorian Weber
+ * @brief Contains the entry point of the map query tool.
+ *
+ * The tool answers questions about a binary dependency map without parsing
+ * it, the map is only mapped into memory.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "depmap.h"
+
+static const char* hlp = "Usage: dsmap <filename> [command]\n"
+	"Commands:\n"
+	"  --help                display this HELP\n"
+	"  --deps <section>      list the DEPendencieS of a section\n"
+	"  --users <section>     list the sections that USE a section\n"
+	"  --xml                 convert the map into the XML format of --dmap\n"
+	"Without a command, a summary of the map is printed.\n";
+
+/**@brief Prints the number of objects, sections and references.
+ */
+static void summary(const depmap* map, FILE* out)
+{
+	const depmapHeader* h = depmapGetHeader(map);
+	uint32_t used = 0, i;
+	
+	for (i = 0; i < h->nodes; ++i)
+		used += depmapGetNode(map, i)->color != 0;
+	
+	fprintf(out, "<SUMMARY files=\"%lu\" sections=\"%lu\" used=\"%lu\" "
+	        "references=\"%lu\"/>\n", (unsigned long) h->files,
+	        (unsigned long) h->nodes, (unsigned long) used,
+	        (unsigned long) h->edges);
+}
+
+/**@brief Prints the sections a section references.
+ */
+static void deps(const depmap* map, uint32_t node, FILE* out)
+{
+	uint32_t count, i;
+	const depmapEdge* edges = depmapGetEdges(map, node, &count);
+	
+	fprintf(out, "<DEPS section=\"%s\">\n", depmapGetName(map, node));
+	
+	for (i = 0; i < count; ++i)
+		fprintf(out, "\t<SECTION weight=\"%lu\">%s</SECTION>\n",
+		        (unsigned long) edges[i].weight,
+		        depmapGetName(map, edges[i].target));
+	
+	fprintf(out, "</DEPS>\n");
+}
+
+/**@brief Prints the sections that reference a section.
+ * @note The edges are stored forward only, so all of them get scanned.
+ */
+static void users(const depmap* map, uint32_t node, FILE* out)
+{
+	const depmapHeader* h = depmapGetHeader(map);
+	uint32_t i;
+	
+	fprintf(out, "<USERS section=\"%s\">\n", depmapGetName(map, node));
+	
+	if (depmapGetNode(map, node)->roots)
+		fprintf(out, "\t<UNKNOWN>%lu</UNKNOWN>\n",
+		        (unsigned long) depmapGetNode(map, node)->roots);
+	
+	for (i = 0; i < h->nodes; ++i)
+	{
+		uint32_t count, j;
+		const depmapEdge* edges = depmapGetEdges(map, i, &count);
+		
+		for (j = 0; j < count; ++j)
+			if (edges[j].target == node)
+				fprintf(out, "\t<SECTION weight=\"%lu\">%s</SECTION>\n",
+				        (unsigned long) edges[j].weight, depmapGetName(map, i));
+	}
+	
+	fprintf(out, "</USERS>\n");
+}
+
+/**@brief Prints the map in the format of deadstripDumpMap().
+ */
+static void xml(const depmap* map, FILE* out)
+{
+	const depmapHeader* h = depmapGetHeader(map);
+	uint32_t i;
+	
+	fprintf(out, "\n<MAP>\n");
+	
+	for (i = 0; i < h->files; ++i)
+	{
+		uint32_t count, j;
+		const uint32_t* members = depmapGetMembers(map, i, &count);
+		const depmapLayout* layouts = depmapGetLayouts(map, i, &count);
+		
+		fprintf(out, "\t<FILE name=\"%s\">\n", depmapGetFile(map, i));
+		
+		for (j = 0; j < count; ++j)
+		{
+			uint32_t edgeCount, k;
+			const depmapEdge* edges = depmapGetEdges(map, members[j], &edgeCount);
+			
+			fprintf(out, "\t\t<SECTION name=\"%s\" color=\"%lu\" size=\"%lu\" "
+			        "align=\"%lu\">\n", depmapGetName(map, members[j]),
+			        (unsigned long) depmapGetNode(map, members[j])->color,
+			        (unsigned long) layouts[j].size, (unsigned long) layouts[j].align);
+			
+			for (k = 0; k < edgeCount; ++k)
+				fprintf(out, "\t\t\t<DEPENDS>%s</DEPENDS>\n",
+				        depmapGetName(map, edges[k].target));
+			
+			fprintf(out, "\t\t</SECTION>\n");
+		}
+		
+		fprintf(out, "\t</FILE>\n");
+	}
+	
+	fprintf(out, "\n</MAP>\n");
+}
+
+int main(int argc, const char* argv[])
+{
+	depmap* map;
+	long node = 0;
+	int res = 0;
+	
+	if (argc < 2 || !strcmp(argv[1], "--help"))
+	{
+		printf("%s", hlp);
+		return argc < 2;
+	}
+	
+	map = depmapOpen(argv[1]);
+	
+	if (!map)
+	{
+		fprintf(stderr, "ERROR: \"%s\" is not a dependency map!\n", argv[1]);
+		return 1;
+	}
+	
+	if (argc > 3 && (!strcmp(argv[2], "--deps") || !strcmp(argv[2], "--users")))
+	{
+		node = depmapFind(map, argv[3]);
+		
+		if (node < 0)
+		{
+			fprintf(stderr, "ERROR: section \"%s\" is unknown!\n", argv[3]);
+			res = 1;
+		}
+		else if (!strcmp(argv[2], "--deps"))
+			deps(map, (uint32_t) node, stdout);
+		else
+			users(map, (uint32_t) node, stdout);
+	}
+	else if (argc > 2 && !strcmp(argv[2], "--xml"))
+		xml(map, stdout);
+	else if (argc > 2)
+	{
+		fprintf(stderr, "ERROR: unknown command \"%s\"!\n%s", argv[2], hlp);
+		res = 1;
+	}
+	else
+		summary(map, stdout);
+	
+	depmapClose(map);
+	return res;
+}
@@ -5,19 +5,81 @@
  ******************************************************************************/
 
 #include "graph.h"
+#include "counters.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
 /* *************************************************************** structures */
 
+#define SO_INDEXED  16  /**<@brief Connections of a node that get walked, more
+                             get looked up in an index. */
+
+/**@brief Slot of the connection index.
+ */
+typedef struct
+{
+	graph* dest; /**< Connected node, \c NULL for a free slot. */
+	void* weight; /**< Position of the weight of the edge. */
+} edge;
+
 struct s_graph
 {
 	unsigned long color;
 	char* name;
 	list* con;
+	list* weight;
+	list* pred;
+	void* datum;
+	unsigned long degree; /**< Number of connections. */
+	void *conTail, *weightTail; /**< Positions of the last connection and its
+	                                 weight, to append without walking. */
+	edge* index; /**< Open addressing table of the connections, \c NULL
+	                  until a node has many of them. */
+	unsigned long mask; /**< Size of the index minus one. */
 };
 
+/* ******************************************************** private functions */
+
+/**@brief Returns the slot of a connection or the free slot to insert it.
+ */
+static edge* findEdge(graph* src, graph* dest)
+{
+	unsigned long i = (unsigned long) ((size_t) dest >> 4) * 0x9e3779b1UL;
+	
+	i ^= i >> 16;
+	
+	while (src->index[i &= src->mask].dest && src->index[i].dest != dest)
+		++i;
+	
+	return src->index + i;
+}
+
+/**@brief Indexes all connections of a node, keeping the index at most half
+ * full.
+ */
+static void buildIndex(graph* src)
+{
+	free(src->index);
+	
+	for (src->mask = 2 * SO_INDEXED - 1; src->mask < 2 * src->degree;)
+		src->mask = (src->mask << 1) | 1;
+	
+	src->index = (edge*) calloc(src->mask + 1, sizeof(edge));
+	
+	listStart(src->con);
+	listStart(src->weight);
+	while (listNext(src->con))
+	{
+		edge* slot;
+		
+		listNext(src->weight);
+		slot = findEdge(src, (graph*) listGet(src->con));
+		slot->dest = (graph*) listGet(src->con);
+		slot->weight = listTell(src->weight);
+	}
+}
+
 /* ******************************************************* exported functions */
 
 graph* newGraph(const char* name)
@@ -27,6 +89,14 @@ graph* newGraph(const char* name)
 	res->color = 0;
 	res->name = strdup(name);
 	res->con = newList();
+	res->weight = newList();
+	res->pred = newList();
+	res->datum = 0;
+	res->degree = 0;
+	res->conTail = listTell(res->con);
+	res->weightTail = listTell(res->weight);
+	res->index = 0;
+	res->mask = 0;
 	
 	return res;
 }
@@ -36,24 +106,133 @@ void deleteGraph(graph* src)
 	assert(src);
 	
 	deleteList(src->con);
+	deleteList(src->weight);
+	deleteList(src->pred);
+	free(src->index);
 	free(src->name);
 	free(src);
 }
 
-void graphConnect(graph* src, const graph* dest)
+unsigned long graphConnect(graph* src, graph* dest)
 {
+	unsigned long walked = 0;
+	edge* slot = 0;
+	
 	assert(src && dest);
 	
 	
-	/* check for double connections - could surely be optimized a bit */
+	/* check for double connections, which are indexed for busy nodes */
+	if (src->degree >= SO_INDEXED)
+	{
+		if (!src->index)
+			buildIndex(src);
+		
+		slot = findEdge(src, dest);
+		++walked;
+		
+		if (slot->dest)
+		{
+			unsigned long w;
+			
+			listSeek(src->weight, slot->weight);
+			w = (unsigned long) listGet(src->weight) + 1;
+			
+			listSet(src->weight, (void*) w);
+			COUNTERS_RECORD(COUNTERS_CONNECT_WALK, walked);
+			return w;
+		}
+	}
+	else
+	{
+		listStart(src->con);
+		listStart(src->weight);
+		while (listNext(src->con))
+		{
+			listNext(src->weight);
+			++walked;
+			
+			if (listGet(src->con) == dest)
+			{
+				unsigned long w = (unsigned long) listGet(src->weight) + 1;
+				
+				listSet(src->weight, (void*) w);
+				COUNTERS_RECORD(COUNTERS_CONNECT_WALK, walked);
+				return w;
+			}
+		}
+	}
+	COUNTERS_RECORD(COUNTERS_CONNECT_WALK, walked);
+	
+	/* check passed, so append that new connection */
+	listSeek(src->con, src->conTail);
+	listAdd(src->con, dest);
+	src->conTail = listTell(src->con);
+	
+	listSeek(src->weight, src->weightTail);
+	listAdd(src->weight, (void*) 1);
+	src->weightTail = listTell(src->weight);
+	
+	++src->degree;
+	
+	if (slot)
+	{
+		slot->dest = dest;
+		slot->weight = src->weightTail;
+		
+		/* grow the index before it gets more than half full */
+		if (2 * src->degree > src->mask)
+			buildIndex(src);
+	}
+	
+	listStart(dest->pred);
+	listAdd(dest->pred, src);
+	return 1;
+}
+
+unsigned long graphDisconnect(graph* src, graph* dest)
+{
+	assert(src && dest);
+	
 	listStart(src->con);
+	listStart(src->weight);
 	while (listNext(src->con))
 	{
+		listNext(src->weight);
 		if (listGet(src->con) == dest)
-			return;
+		{
+			unsigned long w = (unsigned long) listGet(src->weight) - 1;
+			
+			if (w)
+			{
+				listSet(src->weight, (void*) w);
+				return w;
+			}
+			
+			/* the last reference is gone, so drop the edge */
+			listRemove(src->con);
+			listRemove(src->weight);
+			--src->degree;
+			
+			/* the tails may be gone, the index gets rebuilt when needed */
+			while (listNext(src->con));
+			while (listNext(src->weight));
+			src->conTail = listTell(src->con);
+			src->weightTail = listTell(src->weight);
+			free(src->index);
+			src->index = 0;
+			
+			listStart(dest->pred);
+			while (listNext(dest->pred))
+				if (listGet(dest->pred) == src)
+				{
+					listRemove(dest->pred);
+					break;
+				}
+			return 0;
+		}
 	}
-	/* check passed, so add that new connection */
-	listAdd(src->con, dest);
+	
+	return 0;
 }
 
 void graphColorNode(graph* src, unsigned long color)
@@ -74,8 +253,39 @@ const char* graphGetNameNode(graph* src)
 	return src->name;
 }
 
+void graphSetNameNode(graph* src, const char* name)
+{
+	assert(src && name);
+	free(src->name);
+	src->name = strdup(name);
+}
+
+void graphSetDatum(graph* src, void* datum)
+{
+	assert(src);
+	src->datum = datum;
+}
+
+void* graphGetDatum(graph* src)
+{
+	assert(src);
+	return src->datum;
+}
+
 list* graphGetConnections(graph* src)
 {
 	assert(src);
 	return src->con;
 }
+
+list* graphGetWeights(graph* src)
+{
+	assert(src);
+	return src->weight;
+}
+
+list* graphGetPredecessors(graph* src)
+{
+	assert(src);
+	return src->pred;
+}
@@ -25,10 +25,21 @@ extern graph* newGraph(const char* name);
 extern void deleteGraph(graph* src);
 
 /**@brief Connects two graphs in one direction.
+ * @note Connecting the same nodes again only increments the weight of the edge.
+ * 
  * @param[in] src   source node that marks the starting point of the edge
  * @param[in] dest  target node that marks the end point of the edge
+ * @return the weight of the edge, i.e. \c 1 for a new edge
  */
-extern void graphConnect(graph* src, const graph* dest);
+extern unsigned long graphConnect(graph* src, graph* dest);
+
+/**@brief Decrements the weight of an edge and removes it, if the weight drops
+ * to zero.
+ * @param[in] src   source node that marks the starting point of the edge
+ * @param[in] dest  target node that marks the end point of the edge
+ * @return the remaining weight of the edge, i.e. \c 0 if it got removed
+ */
+extern unsigned long graphDisconnect(graph* src, graph* dest);
 
 /**@brief Sets a color value for a certain graph node.
  * @param[in] src    graph node to color
@@ -46,8 +57,31 @@ extern unsigned long graphGetColorNode(graph* src);
  */
 extern const char* graphGetNameNode(graph* src);
 
+/**@brief Replaces the nodes name.
+ */
+extern void graphSetNameNode(graph* src, const char* name);
+
+/**@brief Associates a datum with the node.
+ */
+extern void graphSetDatum(graph* src, void* datum);
+
+/**@brief Returns the datum associated with the node.
+ */
+extern void* graphGetDatum(graph* src);
+
 /**@brief Returns a list of all the other graphs that the node is connected to.
  */
 extern list* graphGetConnections(graph* src);
 
+/**@brief Returns the weights of the connections, in the same order as
+ * graphGetConnections().
+ * @note The weights are stored as <tt>unsigned long</tt> values casted to
+ * pointers.
+ */
+extern list* graphGetWeights(graph* src);
+
+/**@brief Returns a list of all the other graphs that are connected to the node.
+ */
+extern list* graphGetPredecessors(graph* src);
+
 #endif
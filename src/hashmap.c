@@ -5,6 +5,7 @@
  ******************************************************************************/
 
 #include "hashmap.h"
+#include "counters.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -27,12 +28,16 @@ struct sHashmap
 {
 	hashmapEntry* array; /**<@brief Array containing data/key tuples. */
 	size_t size,         /**<@brief Total size of the array (size-1 actually). */
-	       count;        /**<@brief Number of items already saved. */
+	       count,        /**<@brief Number of items already saved. */
+	       removed;      /**<@brief Number of removed entries, which still
+	                                lengthen the probe sequences. */
 };
 
 /* ******************************************************** private functions */
 
 /**@brief Doubles the size of the hashmap and re-inserts all old elements.
+ * @note If most of the used entries are removed ones, the size stays and they
+ * just get dropped.
  */
 static void rehash(hashmap* map);
 
@@ -49,6 +54,11 @@ static int insert(hashmap* map, void* data, char* key);
  */
 static hashmapEntry* find(const hashmap* map, const char* key);
 
+/**@brief Does the work of find() and counts the visited slots.
+ */
+static hashmapEntry* probe(const hashmap* map, const char* key,
+                           unsigned long* probes);
+
 /**@brief Compares two hashmap entries lexicographically according to their
  * keys, if they exist.
  */
@@ -87,17 +97,42 @@ static unsigned long hash2(const char* rawKey)
 	return hash;
 }
 
+#ifdef DEADSTRIP_COUNTERS
+/**@brief Counts the removed entries of an array that gets dropped.
+ */
+static void countTombstones(const hashmapEntry* array, size_t size)
+{
+	unsigned long tombstones = 0;
+	size_t i;
+	
+	for (i = 0; i < size; ++i)
+		tombstones += !array[i].key && array[i].data;
+	
+	COUNTERS_MAX(COUNTERS_TOMBSTONE_RATIO, tombstones * 1000 / size);
+}
+#endif
+
 static void rehash(hashmap* map)
 {
 	size_t size;
 	hashmapEntry* array = map->array;
+	unsigned long start = COUNTERS_CLOCK();
+
+#ifdef DEADSTRIP_COUNTERS
+	countTombstones(array, map->size + 1);
+#endif
 	
-	/* double the size of the array */
+	/* double the size of the array, unless half of it is free without the
+	 * removed entries */
 	size = ++map->size;
-	map->size <<= 1;
+	
+	if (2 * (map->count + 1) > size)
+		map->size <<= 1;
+	
 	map->array = (hashmapEntry*) calloc(sizeof(hashmapEntry), map->size);
 	--map->size;
 	map->count = 0;
+	map->removed = 0;
 	
 	/* re-insert all elements */
 	do
@@ -108,11 +143,24 @@ static void rehash(hashmap* map)
 	}
 	while (size);
 	
+	COUNTERS_ADD(COUNTERS_REHASHES, 1);
+	COUNTERS_ADD(COUNTERS_REHASH_TIME, COUNTERS_CLOCK() - start);
+	
 	/* return unused memory */
 	free(array);
 }
 
 static hashmapEntry* find(const hashmap* map, const char* key)
+{
+	unsigned long probes = 1;
+	hashmapEntry* res = probe(map, key, &probes);
+	
+	COUNTERS_RECORD(COUNTERS_PROBES, probes);
+	return res;
+}
+
+static hashmapEntry* probe(const hashmap* map, const char* key,
+                           unsigned long* probes)
 {
 	unsigned long index, step, initialIndex;
 	hashmapEntry* freeEntry = 0;
@@ -134,12 +182,14 @@ static hashmapEntry* find(const hashmap* map, const char* key)
 		freeEntry = &map->array[index];
 	}
 	
-	/* collision */
-	step = (hash2(key) % map->size) + 1;
+	/* collision, an odd step visits every slot of the power of two sized
+	 * table before returning to the first one */
+	step = (hash2(key) & map->size) | 1;
 	
 	do
 	{
 		index = (index + step) & map->size;
+		++*probes;
 		
 		if (map->array[index].key)
 		{
@@ -164,7 +214,8 @@ static int insert(hashmap* map, void* data, char* key)
 {
 	hashmapEntry* entry;
 	
-	if (map->size == map->count)
+	/* long probe sequences start way before the array is full */
+	if (4 * (map->count + map->removed + 1) > 3 * (map->size + 1))
 		rehash(map);
 	
 	do
@@ -173,6 +224,12 @@ static int insert(hashmap* map, void* data, char* key)
 		
 		if (entry)
 		{
+			if (!entry->key && entry->data)
+			{
+				COUNTERS_ADD(COUNTERS_TOMBSTONES_REUSED, 1);
+				--map->removed;
+			}
+			
 			entry->data = data;
 			
 			if (entry->key)
@@ -227,6 +284,7 @@ hashmap* newHashmap(unsigned int hint)
 	map->array = (hashmapEntry*) calloc(sizeof(hashmapEntry), hint);
 	map->size = hint - 1;
 	map->count = 0;
+	map->removed = 0;
 	
 	return map;
 }
@@ -244,6 +302,9 @@ void deleteHashmap(hashmap* map)
 	}
 	while (++index <= map->size);
 
+#ifdef DEADSTRIP_COUNTERS
+	countTombstones(map->array, map->size + 1);
+#endif
 	free(map->array);
 	free(map);
 }
@@ -286,6 +347,8 @@ void* hashmapRemove(hashmap* map, const char* key)
 		
 		/* setting exist to one indicates that this entry was already in use */
 		entry->data = (void*) 1;
+		++map->removed;
+		COUNTERS_ADD(COUNTERS_TOMBSTONES, 1);
 	}
 	
 	return res;
@@ -294,19 +357,21 @@ void* hashmapRemove(hashmap* map, const char* key)
 void hashmapProcess(const hashmap* map, fHashmapProc proc)
 {
 	hashmapEntry* array;
-	size_t size;
-	unsigned int i;
+	size_t i, count = 0;
 	
 	assert(map);
 	
-	size = map->size + 1;
-	array = (hashmapEntry*) malloc(sizeof(hashmapEntry) * size);
+	/* only the occupied entries get sorted */
+	array = (hashmapEntry*) malloc(sizeof(hashmapEntry) * (map->count + 1));
+	
+	for (i = 0; i <= map->size; ++i)
+		if (map->array[i].key)
+			array[count++] = map->array[i];
 	
-	memcpy(array, map->array, sizeof(hashmapEntry) * size);
-	qsort(array, size, sizeof(hashmapEntry),
+	qsort(array, count, sizeof(hashmapEntry),
 				(int(*)(const void*, const void*)) compare);
 	
-	for (i = 0; i < map->count; ++i)
+	for (i = 0; i < count; ++i)
 		proc(array[i].key, array[i].data);
 	
 	free(array);
@@ -0,0 +1,627 @@
+/***************************************************************************//**
+ * @file icf.c
+ * @author Dorian Weber
+ * @brief Implementation of the identical code folding.
+ ******************************************************************************/
+
+#include "icf.h"
+#include "hashmap.h"
+#include "parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* *************************************************************** structures */
+
+#define SO_FUNCTION    ".text$"         /**<@brief Prefix of function sections. */
+#define SO_CONTENTS    "Contents of section "
+#define SO_FNV_BASIS   2166136261UL     /**<@brief FNV 32-Bit offset basis. */
+#define SO_FNV_PRIME   16777619UL       /**<@brief FNV 32-Bit prime. */
+#define SO_SHARED      ((size_t) -1)    /**<@brief Owner of keys declared by several objects. */
+
+/**@brief A function section that might get folded.
+ */
+typedef struct s_candidate
+{
+	char* name; /**< Section name. */
+	const char* key; /**< Key of the section, points into the name. */
+	objectFile* obj; /**< Object that declares the section. */
+	size_t object; /**< Position of the object in link order, from 1. */
+	list* targets; /**< Keys of the referenced symbols, may be \c NULL. */
+	list* offsets; /**< Offsets of the relocations, may be \c NULL. */
+	list* types; /**< Types of the relocations, may be \c NULL. */
+	struct s_candidate** refs; /**< Referenced candidates, \c NULL for others. */
+	size_t* scopes; /**< Objects of object-local targets, \c 0 for global ones. */
+	size_t count; /**< Number of referenced symbols. */
+	unsigned char* bytes; /**< Contents. */
+	size_t length; /**< Number of bytes. */
+	size_t capacity; /**< Size of the content buffer. */
+	int collected; /**< Set, if the contents were found. */
+	unsigned long hash; /**< Hash of the contents, later of the signature. */
+	size_t cls; /**< Class of identical sections. */
+	size_t prev; /**< Class during the last refinement. */
+	struct s_candidate* rep; /**< Representative, \c NULL for itself. */
+	struct s_candidate* next; /**< Next member of the same group. */
+} candidate;
+
+/**@brief Result of the identical code folding.
+ */
+struct s_icf
+{
+	deadstrip* ctx; /**< Analysis context. */
+	hashmap* map; /**< Maps keys to the candidates, 1-based. */
+	candidate* cands; /**< Candidates in link order. */
+	size_t count; /**< Number of candidates. */
+};
+
+/**@brief Work shared by the threads.
+ */
+typedef struct
+{
+	candidate* cands; /**< All candidates. */
+	void (*fn)(candidate*); /**< Processing function. */
+	stats* st; /**< Statistics that trace the threads. */
+	const char* name; /**< Name of the work in traces. */
+} job;
+
+/* ******************************************************** private functions */
+
+/**@brief Mixes a value into a FNV hash.
+ */
+static unsigned long mix(unsigned long hash, unsigned long value)
+{
+	int i;
+	
+	for (i = 0; i < 4; ++i, value >>= 8)
+		hash = ((hash ^ (value & 0xff)) * SO_FNV_PRIME) & 0xffffffffUL;
+	
+	return hash;
+}
+
+/**@brief Hashes the contents of a candidate together with the offsets and
+ * types of its relocations.
+ */
+static void hashContents(candidate* src)
+{
+	unsigned long hash = mix(SO_FNV_BASIS, src->count);
+	size_t i;
+	
+	for (i = 0; i < src->length; ++i)
+		hash = ((hash ^ src->bytes[i]) * SO_FNV_PRIME) & 0xffffffffUL;
+	
+	if (src->offsets)
+	{
+		listStart(src->offsets);
+		listStart(src->types);
+		while (listNext(src->offsets) && listNext(src->types))
+		{
+			const unsigned char* s = (const unsigned char*) listGet(src->types);
+			
+			hash = mix(hash, (unsigned long) listGet(src->offsets));
+			while (*s)
+				hash = ((hash ^ *s++) * SO_FNV_PRIME) & 0xffffffffUL;
+		}
+	}
+	
+	src->hash = hash;
+}
+
+/**@brief Hashes the class of a candidate together with the classes of the
+ * referenced candidates and the names and scopes of other referenced symbols.
+ */
+static void hashSignature(candidate* src)
+{
+	unsigned long hash = mix(SO_FNV_BASIS, src->prev);
+	size_t i = 0;
+	
+	if (src->targets)
+	{
+		listStart(src->targets);
+		while (listNext(src->targets))
+		{
+			const unsigned char* s = (const unsigned char*) listGet(src->targets);
+			
+			if (src->refs[i])
+				hash = mix(hash, src->refs[i]->prev);
+			else
+			{
+				while (*s)
+					hash = ((hash ^ *s++) * SO_FNV_PRIME) & 0xffffffffUL;
+				
+				hash = mix(hash, src->scopes[i]);
+			}
+			++i;
+		}
+	}
+	
+	src->hash = hash;
+}
+
+/**@brief Processes a range of candidates.
+ */
+static void work(void* arg, size_t begin, size_t end)
+{
+	job* j = (job*) arg;
+	double start = statsTime();
+	
+	for (; begin < end; ++begin)
+		j->fn(j->cands + begin);
+	
+	statsSpan(j->st, "worker", j->name, 0, start);
+}
+
+/**@brief Processes all candidates, spread over several threads.
+ */
+static void parallel(icf* src, void (*fn)(candidate*), const char* name,
+                     int threads)
+{
+	job j;
+	
+	j.cands = src->cands;
+	j.fn = fn;
+	j.st = deadstripGetStats(src->ctx);
+	j.name = name;
+	parallelFor(src->count, threads, work, &j);
+}
+
+/**@brief Orders candidates by their contents and the offsets and types of
+ * their relocations, uncollected ones last.
+ */
+static int compareContents(const void* a, const void* b)
+{
+	const candidate *x = *(const candidate* const*) a, *y = *(const candidate* const*) b;
+	int res;
+	
+	if (x->collected != y->collected)
+		return y->collected - x->collected;
+	if (!x->collected)
+		return (x < y) ? -1 : (x > y);
+	if (x->length != y->length)
+		return (x->length < y->length) ? -1 : 1;
+	if (x->hash != y->hash)
+		return (x->hash < y->hash) ? -1 : 1;
+	if (x->count != y->count)
+		return (x->count < y->count) ? -1 : 1;
+	if ((res = memcmp(x->bytes, y->bytes, x->length)) || !x->count)
+		return res;
+	
+	/* the same targets may be referenced at different places or differently */
+	listStart(x->offsets);
+	listStart(y->offsets);
+	listStart(x->types);
+	listStart(y->types);
+	while (listNext(x->offsets) && listNext(y->offsets) && listNext(x->types)
+	       && listNext(y->types))
+	{
+		unsigned long ox = (unsigned long) listGet(x->offsets);
+		unsigned long oy = (unsigned long) listGet(y->offsets);
+		
+		if (ox != oy)
+			return (ox < oy) ? -1 : 1;
+		if ((res = strcmp((const char*) listGet(x->types),
+		                  (const char*) listGet(y->types))))
+			return res;
+	}
+	
+	return 0;
+}
+
+/**@brief Orders candidates by their class and the classes of their targets.
+ */
+static int compareSignature(const void* a, const void* b)
+{
+	const candidate *x = *(const candidate* const*) a, *y = *(const candidate* const*) b;
+	size_t i = 0;
+	
+	if (x->prev != y->prev)
+		return (x->prev < y->prev) ? -1 : 1;
+	if (x->hash != y->hash)
+		return (x->hash < y->hash) ? -1 : 1;
+	if (!x->targets)
+		return 0;
+	
+	/* both have the same number of targets, since their contents match */
+	listStart(x->targets);
+	listStart(y->targets);
+	while (listNext(x->targets) && listNext(y->targets))
+	{
+		const candidate *rx = x->refs[i], *ry = y->refs[i];
+		int res;
+		
+		if (rx && ry)
+			res = (rx->prev != ry->prev) ? ((rx->prev < ry->prev) ? -1 : 1) : 0;
+		else if (rx || ry)
+			res = (rx) ? -1 : 1;
+		else if (!(res = strcmp((const char*) listGet(x->targets),
+		                        (const char*) listGet(y->targets))))
+			/* object-local targets of the same name are still different */
+			res = (x->scopes[i] != y->scopes[i])
+				? ((x->scopes[i] < y->scopes[i]) ? -1 : 1) : 0;
+		
+		if (res)
+			return res;
+		++i;
+	}
+	
+	return 0;
+}
+
+/**@brief Assigns classes to sorted candidates, a new one starts whenever the
+ * comparison tells two neighbours apart.
+ * @return number of classes
+ */
+static size_t classify(candidate** sorted, size_t count,
+                       int (*cmp)(const void*, const void*))
+{
+	size_t i, res = 0;
+	
+	for (i = 0; i < count; ++i)
+	{
+		if (!i || cmp(sorted + i - 1, sorted + i))
+			++res;
+		
+		sorted[i]->cls = res;
+	}
+	
+	return res;
+}
+
+/**@brief Orders representatives by the bytes that folding their groups saves.
+ */
+static int compareSavings(const void* a, const void* b)
+{
+	const candidate *x = *(const candidate* const*) a, *y = *(const candidate* const*) b;
+	size_t sx = 0, sy = 0;
+	const candidate* c;
+	
+	for (c = x->next; c; c = c->next)
+		sx += c->length;
+	for (c = y->next; c; c = c->next)
+		sy += c->length;
+	
+	if (sx != sy)
+		return (sx < sy) ? 1 : -1;
+	
+	return (x < y) ? -1 : (x > y);
+}
+
+/**@brief Appends bytes in hexadecimal notation to the contents of a candidate.
+ * @return pointer behind the parsed characters
+ */
+static const char* parseHex(candidate* dest, const char* src)
+{
+	while (isxdigit((unsigned char) src[0]) && isxdigit((unsigned char) src[1]))
+	{
+		char byte[3];
+		
+		if (dest->length == dest->capacity)
+		{
+			dest->capacity = (dest->capacity) ? dest->capacity << 1 : 64;
+			dest->bytes = (unsigned char*) realloc(dest->bytes, dest->capacity);
+		}
+		
+		byte[0] = src[0];
+		byte[1] = src[1];
+		byte[2] = 0;
+		dest->bytes[dest->length++] = (unsigned char) strtoul(byte, 0, 16);
+		src += 2;
+	}
+	
+	return src;
+}
+
+/* ******************************************************* exported functions */
+
+icf* newIcf(deadstrip* ctx)
+{
+	icf* res = (icf*) malloc(sizeof(icf));
+	list* objects = deadstripGetObjects(ctx);
+	hashmap* owners = newHashmap(64);
+	size_t size = 64, object = 0, i;
+	
+	res->ctx = ctx;
+	res->map = newHashmap(64);
+	res->cands = (candidate*) malloc(sizeof(candidate) * size);
+	res->count = 0;
+	
+	
+	/* keys declared by several objects may belong to different statics */
+	listStart(objects);
+	while (listNext(objects))
+	{
+		list* sects = objectFileGetSections((objectFile*) listGet(objects));
+		
+		++object;
+		
+		listStart(sects);
+		while (listNext(sects))
+		{
+			const char* key = objectFileKey((const char*) listGet(sects));
+			size_t owner = (key) ? (size_t) hashmapGet(owners, key) : 0;
+			
+			if (key && owner != object)
+				hashmapSet(owners, (void*) ((owner) ? SO_SHARED : object), key);
+		}
+	}
+	
+	
+	/* collect the used function sections together with their relocations */
+	object = 0;
+	listStart(objects);
+	while (listNext(objects))
+	{
+		objectFile* obj = (objectFile*) listGet(objects);
+		list* used = deadstripGetUsed(ctx, obj);
+		list* tables = objectFileGetTables(obj);
+		hashmap* relocs = newHashmap(listCount(tables) + 1);
+		
+		++object;
+		
+		listStart(tables);
+		while (listNext(tables))
+		{
+			objectFileTable* table = (objectFileTable*) listGet(tables);
+			hashmapSet(relocs, table, table->section);
+		}
+		
+		listStart(used);
+		while (listNext(used))
+		{
+			const char* name = (const char*) listGet(used);
+			objectFileTable* table;
+			candidate* c;
+			
+			/* sections declared by several objects aren't folded, since
+			 their declarations may differ */
+			if (strncmp(name, SO_FUNCTION, sizeof(SO_FUNCTION) - 1)
+			    || (size_t) hashmapGet(owners, objectFileKey(name)) == SO_SHARED)
+				continue;
+			
+			if (res->count == size)
+			{
+				size <<= 1;
+				res->cands = (candidate*) realloc(res->cands, sizeof(candidate) * size);
+			}
+			
+			c = res->cands + res->count++;
+			memset(c, 0, sizeof(candidate));
+			c->name = strdup(name);
+			c->key = objectFileKey(c->name);
+			c->obj = obj;
+			c->object = object;
+			
+			table = (objectFileTable*) hashmapGet(relocs, c->key);
+			if (table)
+			{
+				c->targets = table->targets;
+				c->offsets = table->offsets;
+				c->types = table->types;
+				c->count = listCount(table->targets);
+			}
+			
+			hashmapSet(res->map, (void*) res->count, c->key);
+		}
+		
+		deleteHashmap(relocs);
+		deleteList(used);
+	}
+	
+	
+	/* resolve the targets, now that the array doesn't move anymore */
+	for (i = 0; i < res->count; ++i)
+	{
+		candidate* c = res->cands + i;
+		size_t j = 0;
+		
+		if (!c->targets)
+			continue;
+		
+		c->refs = (candidate**) malloc(sizeof(candidate*) * (c->count + 1));
+		c->scopes = (size_t*) malloc(sizeof(size_t) * (c->count + 1));
+		
+		listStart(c->targets);
+		while (listNext(c->targets))
+		{
+			const char* target = (const char*) listGet(c->targets);
+			size_t ref = (size_t) hashmapGet(res->map, target);
+			
+			/* unprefixed sections, like .rdata, and shared keys only match
+			 within the same object */
+			c->scopes[j] = (*target == '.'
+			                || (size_t) hashmapGet(owners, target) == SO_SHARED)
+				? c->object : 0;
+			c->refs[j] = (ref && !c->scopes[j]) ? res->cands + ref - 1 : 0;
+			++j;
+		}
+	}
+	
+	deleteHashmap(owners);
+	return res;
+}
+
+void deleteIcf(icf* src)
+{
+	size_t i;
+	
+	for (i = 0; i < src->count; ++i)
+	{
+		free(src->cands[i].name);
+		free(src->cands[i].refs);
+		free(src->cands[i].scopes);
+		free(src->cands[i].bytes);
+	}
+	
+	deleteHashmap(src->map);
+	free(src->cands);
+	free(src);
+}
+
+int icfCollect(icf* src, FILE* file)
+{
+	char* line = 0;
+	size_t size = 0;
+	objectFile* obj = 0;
+	candidate* curr = 0;
+	
+	while (getline(&line, &size, file) > 0)
+	{
+		char* ptr;
+		
+		/* the output of the next file begins */
+		if ((ptr = strstr(line, "file format")))
+		{
+			while (ptr > line && (isspace((unsigned char) ptr[-1]) || ptr[-1] == ':'))
+				--ptr;
+			
+			*ptr = 0;
+			obj = deadstripGetObject(src->ctx, line);
+			curr = 0;
+		}
+		
+		/* the contents of the next section begin */
+		else if (!strncmp(line, SO_CONTENTS, sizeof(SO_CONTENTS) - 1))
+		{
+			const char* key;
+			size_t index;
+			
+			ptr = line + sizeof(SO_CONTENTS) - 1;
+			ptr[strcspn(ptr, ":\r\n")] = 0;
+			
+			key = objectFileKey(ptr);
+			index = (key) ? (size_t) hashmapGet(src->map, key) : 0;
+			curr = (index) ? src->cands + index - 1 : 0;
+			
+			/* only the declaration that was chosen as candidate counts */
+			if (curr && (curr->obj != obj || curr->collected))
+				curr = 0;
+			if (curr)
+				curr->collected = 1;
+		}
+		
+		/* a line looks like " 0010 5589e583 ec08c745 fc000000 00c9c3   U..." */
+		else if (curr && *line == ' ' && isxdigit((unsigned char) line[1]))
+		{
+			const char* p = line + 1;
+			int group = 0;
+			
+			while (isxdigit((unsigned char) *p))
+				++p;
+			
+			/* groups are separated by a single space, the text by two */
+			while (group++ < 4 && p[0] == ' ' && p[1] != ' ')
+				p = parseHex(curr, p + 1);
+		}
+		else
+			curr = 0;
+	}
+	
+	free(line);
+	return 1;
+}
+
+void icfCompute(icf* src, int threads)
+{
+	candidate** sorted = (candidate**) malloc(sizeof(candidate*) * (src->count + 1));
+	size_t classes, last, i;
+	
+	for (i = 0; i < src->count; ++i)
+	{
+		candidate* c = src->cands + i;
+		
+		sorted[i] = c;
+		c->rep = c->next = 0;
+	}
+	
+	
+	/* start with groups of equal contents */
+	parallel(src, hashContents, "hash contents", threads);
+	qsort(sorted, src->count, sizeof(candidate*), compareContents);
+	classes = classify(sorted, src->count, compareContents);
+	
+	
+	/* split groups whose targets differ, until nothing changes anymore */
+	do
+	{
+		last = classes;
+		
+		for (i = 0; i < src->count; ++i)
+			src->cands[i].prev = src->cands[i].cls;
+		
+		parallel(src, hashSignature, "hash signatures", threads);
+		qsort(sorted, src->count, sizeof(candidate*), compareSignature);
+		classes = classify(sorted, src->count, compareSignature);
+	}
+	while (classes != last);
+	
+	
+	/* the first member in link order represents the group */
+	for (i = 0; i < src->count; ++i)
+		sorted[i] = 0;
+	
+	for (i = 0; i < src->count; ++i)
+		if (!sorted[src->cands[i].cls - 1])
+			sorted[src->cands[i].cls - 1] = src->cands + i;
+	
+	/* the others get chained in link order as well */
+	for (i = src->count; i--;)
+	{
+		candidate* c = src->cands + i;
+		candidate* rep = sorted[c->cls - 1];
+		
+		if (rep != c)
+		{
+			c->rep = rep;
+			c->next = rep->next;
+			rep->next = c;
+		}
+	}
+	
+	free(sorted);
+}
+
+void icfFold(icf* src)
+{
+	size_t i;
+	
+	for (i = 0; i < src->count; ++i)
+		if (src->cands[i].rep)
+			deadstripFold(src->ctx, src->cands[i].key, src->cands[i].rep->key);
+}
+
+void icfDump(icf* src, FILE* out)
+{
+	candidate** reps = (candidate**) malloc(sizeof(candidate*) * (src->count + 1));
+	size_t count = 0, saved = 0, i;
+	
+	for (i = 0; i < src->count; ++i)
+	{
+		candidate* c = src->cands + i;
+		
+		if (c->rep)
+			saved += c->length;
+		else if (c->next)
+			reps[count++] = c;
+	}
+	
+	qsort(reps, count, sizeof(candidate*), compareSavings);
+	
+	fprintf(out, "\n<FOLDS groups=\"%lu\" saved=\"%lu\">\n", (unsigned long) count,
+	        (unsigned long) saved);
+	
+	for (i = 0; i < count; ++i)
+	{
+		candidate* c;
+		
+		fprintf(out, "\t<GROUP size=\"%lu\" representative=\"%s\">\n",
+		        (unsigned long) reps[i]->length, reps[i]->name);
+		
+		for (c = reps[i]->next; c; c = c->next)
+			fprintf(out, "\t\t<SECTION>%s</SECTION>\n", c->name);
+		
+		fprintf(out, "\t</GROUP>\n");
+	}
+	
+	fprintf(out, "</FOLDS>\n");
+	free(reps);
+}
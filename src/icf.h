@@ -0,0 +1,80 @@
+/***************************************************************************//**
+ * @file icf.h
+ * @author Dorian Weber
+ * @brief Interface of the identical code folding.
+ *
+ * Finds used function sections with identical contents, whose relocations
+ * refer to identical targets. The contents are read from the output of
+ * <tt>objdump -s</tt>, hashed in parallel and grouped by size and hash first.
+ * Those groups get refined by the classes of the referenced sections until
+ * they don't change anymore, so mutually recursive functions are folded, too.
+ * Targets that may differ between objects, i.e. unprefixed sections like
+ * \c .rdata and keys declared by several objects, only match within the same
+ * object; function sections declared by several objects aren't candidates.
+ *
+ * Folding treats all members of a group but the first one as unused. The
+ * linker has to define their symbols as aliases of the remaining one, which
+ * means their addresses aren't distinct anymore.
+ *
+ * @sa icf.c
+ ******************************************************************************/
+
+#ifndef ICF_H_INCLUDED
+#define ICF_H_INCLUDED
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "deadstrip.h"
+
+/* forward declaration of opaque structure */
+typedef struct s_icf icf;
+
+/**@brief Creates the candidates for folding, which are all used function
+ * sections of an analysis.
+ * @note The analysis must not change while the result is in use.
+ *
+ * @param[in] ctx  analysis context
+ * @return pointer to the result
+ */
+extern icf* newIcf(deadstrip* ctx);
+
+/**@brief Frees the result.
+ */
+extern void deleteIcf(icf* src);
+
+/**@brief Collects the contents of the candidates.
+ * @note Candidates without contents are never folded.
+ *
+ * @param[in] src   the result
+ * @param[in] file  output of <tt>objdump -s</tt>
+ * @return \c 1 on success, \c 0 if the file has an invalid format
+ */
+extern int icfCollect(icf* src, FILE* file);
+
+/**@brief Groups the identical sections.
+ *
+ * @param[in] src      the result
+ * @param[in] threads  number of threads to hash with, \c 0 for one per
+ *                     processor
+ */
+extern void icfCompute(icf* src, int threads);
+
+/**@brief Folds all members of a group into its first one.
+ * @sa deadstripFold()
+ */
+extern void icfFold(icf* src);
+
+/**@brief Dumps the groups of identical sections in XML-like format, ordered
+ * by the bytes that folding them saves.
+ */
+extern void icfDump(icf* src, FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -20,6 +20,7 @@ typedef struct s_element
 struct s_list
 {
 	element *top, *curr;
+	element* prev; /**< Predecessor of the current element, \c NULL if unknown. */
 };
 
 /* ******************************************************* exported functions */
@@ -28,6 +29,7 @@ list* newList()
 {
 	list* res = (list*) malloc(sizeof(list));
 	res->curr = res->top = (element*) calloc(1, sizeof(element));
+	res->prev = 0;
 	return res;
 }
 
@@ -53,23 +55,32 @@ void listAdd(list* src, const void* data)
 	
 	nE->data = (void*) data;
 	nE->next = src->curr->next;
+	src->prev = src->curr;
 	src->curr = src->curr->next = nE;
 }
 
 void listRemove(list* src)
 {
-	element* tmp;
+	element *tmp, *prev;
 	
 	assert(src);
 	
 	tmp = src->curr;
+	prev = src->prev;
 	
 	if (src->top == tmp)
+	{
 		tmp = tmp->next;
-	if (src->top->next == tmp)
-		src->top->next = tmp->next;
+		prev = src->top;
+	}
 	
-	src->curr = tmp->next;
+	/* only search the predecessor if the cursor didn't get here by walking */
+	if (!prev)
+		for (prev = src->top; prev->next != tmp; prev = prev->next);
+	
+	prev->next = tmp->next;
+	src->curr = prev;
+	src->prev = 0;
 	free(tmp);
 }
 
@@ -92,6 +103,7 @@ int listNext(list* src)
 	assert(src);
 	if (src->curr->next)
 	{
+		src->prev = src->curr;
 		src->curr = src->curr->next;
 		return 1;
 	}
@@ -102,6 +114,20 @@ void listStart(list* src)
 {
 	assert(src);
 	src->curr = src->top;
+	src->prev = 0;
+}
+
+void* listTell(list* src)
+{
+	assert(src);
+	return src->curr;
+}
+
+void listSeek(list* src, void* pos)
+{
+	assert(src && pos);
+	src->curr = (element*) pos;
+	src->prev = 0;
 }
 
 int listCount(list* src)
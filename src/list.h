@@ -29,6 +29,10 @@ extern void listAdd(list* src, const void* data);
 
 /**@brief Removes the currently selected item.
  * @pre A valid element is selected.
+ * @post The previous element is selected, so listNext() continues with the
+ * element that followed the removed one.
+ * @note Takes constant time if the element was reached by listNext() or
+ * listAdd(), otherwise the list is searched for its predecessor.
  * 
  * @param[in] src  list to remove from
  */
@@ -62,6 +66,22 @@ extern int listNext(list* src);
  */
 extern void listStart(list* src);
 
+/**@brief Returns the position of the current element, which stays valid
+ * until that element gets removed.
+ * 
+ * @param[in] src  list to query
+ * @return opaque position, to be passed to listSeek()
+ */
+extern void* listTell(list* src);
+
+/**@brief Selects the element at a position returned by listTell(), without
+ * walking the list.
+ * 
+ * @param[in] src  list to position
+ * @param[in] pos  position of an element of the same list
+ */
+extern void listSeek(list* src, void* pos);
+
 /**@brief Counts the list.
  * @param[in] src  list to count
  * @return number of items currently stored
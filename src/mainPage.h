@@ -102,11 +102,52 @@
      --ddis                dumps discarted sections
      --duse                dumps used sections
      --dmap                dump the dependency map
+     --bmap <filename>     write the dependency map in binary format
+       > query it using dsmap
+     --emit-dot <filename> emit the dependency graph in DOT format
+     --emit-json <filename>
+                           emit the dependency graph in JSON format
+     --emit-live           emit only the live, i.e. used sections
+     --emit-dead           emit only the dead, i.e. unused sections
+     --emit-around <item>  emit only the sections connected to an item
+     --emit-depth <n>      emit sections at most n references around the item
+     --emit-objects        emit every object as a single node
+     --from-map <filename> analyze a saved dependency map instead of objects
+       > nothing gets removed or linked, both map formats are understood
+     --dret                dump the retained size of every used section
+     --dsav                dump the saved bytes per object and kind
      --linker <filename>   use alternative linker (default: ld)
+     --dumper <filename>   use alternative dumper (default: objdump)
+     --remover <filename>  use alternative remover (default: objcopy)
      --dnrm                do not remove any sections
+     --stats               dump time and memory statistics per phase
+     --stats-json <filename>
+                           write the statistics in JSON format
+     --trace <filename>    write a trace of phases, objects and subprocesses
+       > open it in Perfetto or chrome://tracing
+     --profile <filename>  read a profile of "symbol count" lines
+     --order <filename>    write an ordering file, hot sections come first
+       > pass it to the linker using --section-ordering-file
+     --cluster             cluster callers and callees in the ordering file
+     --icf                 report identical code that could be folded
+     --fold                fold identical code into one section
+       > the folded functions lose their distinct addresses
+     --script <filename>   discard sections by a linker script fragment
+       > the objects stay untouched, the linker gets passed the script
+     --verify              verify the incrementally computed colors
+     --threads <n>         number of threads for reports and --icf
+       > the default of 0 uses one per processor
      --save <item>         save an item and its dependencies
        > just pass the decorated variable/function name, not the section
        > the main function gets saved by default
+     --why <item>          explain why an item is kept
+     --who-uses <item>     list the sections that reference an item
+     --serve <socket>      keep analyses in memory and serve requests
+     --client <socket> <command> [argument...]
+                           send a request to a running server
+       > commands are link, query, drop and stop
+     --watch [option...] file...
+                           relink whenever one of the objects changes
  @endverbatim
  * 
  * @section notes Additional Notes
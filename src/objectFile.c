@@ -5,35 +5,60 @@
  ******************************************************************************/
 
 #include "objectFile.h"
-#include "hashmap.h"
-#include "graph.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/stat.h>
 
 /* *************************************************************** structures */
 
 #define SO_FOUNDNAME     1
 #define SO_FOUNDSECTION  2
+#define SO_FOUNDRELOCS   3
+
+/* nanoseconds of the modification time, where the platform records them */
+#if defined(_WIN32)
+#define SO_MTIME_NSEC(st)  0L
+#elif defined(__APPLE__)
+#define SO_MTIME_NSEC(st)  ((long) (st).st_mtimespec.tv_nsec)
+#else
+#define SO_MTIME_NSEC(st)  ((long) (st).st_mtim.tv_nsec)
+#endif
 
 #define SO_PREFIX_COUNT (sizeof(prefix)/sizeof(char*))
-#define SO_WEAK_COUNT  (sizeof(weak)/sizeof(char*))
 
 static const char* prefix[] =
 	{ ".text$", ".rdata$", ".data$" };
-static const char* weak[] =
-	{ ".rdata" };
 
-static hashmap* sectionMap = 0;
-static list* unknownSection = 0;
+#define SO_ASSOC_COUNT (sizeof(assoc)/sizeof(char*))
+
+/* sections that belong to the function section of the same name */
+static const char* assoc[] =
+	{ ".pdata$", ".xdata$" };
+
+#define SO_SAFE_COUNT (sizeof(safe)/sizeof(char*))
+
+/* sections without a prefix that can go together with the object */
+static const char* safe[] =
+	{ ".debug", ".zdebug", ".stab", ".comment" };
 
 /**@brief Intermediate data used for object files.
  */
 struct s_objectFile
 {
-	const char* name; /**< File name. */
+	char* name; /**< File name. */
 	list* sects; /**< List of sections. */
+	list* sizes; /**< Sizes of the sections, in the same order. */
+	list* aligns; /**< Alignments of the sections, in the same order. */
+	list* tables; /**< List of relocation tables. */
+	time_t mtime; /**< Modification time at the last refresh. */
+	long mtimeNsec; /**< Nanoseconds of the modification time. */
+	long size; /**< File size at the last refresh. */
+	unsigned long inode; /**< Inode at the last refresh. */
+	unsigned long device; /**< Device of the inode. */
+	int stale; /**< Set, if sections and tables need to be collected. */
+	int pinned; /**< Number of sections that can't be removed. */
 };
 
 /* ******************************************************** private functions */
@@ -61,39 +86,136 @@ static void upper(char* src)
 	}
 }
 
+/**@brief Finds the stale object that is named in the header line of a dump,
+ * starting at the current position of the list.
+ * @param[in] objects  list of object files
+ * @param[in] header   header line, which starts with the file name
+ * @return the object file or \c NULL, if it isn't listed or not stale
+ */
+static objectFile* findStale(list* objects, const char* header)
+{
+	int wrapped = 0;
+	
+	do
+	{
+		while (listNext(objects))
+		{
+			objectFile* obj = (objectFile*) listGet(objects);
+			size_t len = strlen(obj->name);
+			
+			if (obj->stale && !strncmp(header, obj->name, len) && header[len] == ':')
+				return obj;
+		}
+		listStart(objects);
+	}
+	while (!wrapped++);
+	
+	return 0;
+}
+
+/**@brief Checks, whether a section without a known prefix keeps the object
+ * alive, i.e. it has content that isn't just debug information.
+ * @param[in] name  section name
+ * @param[in] size  size column of the section table
+ */
+static int isPinned(const char* name, const char* size)
+{
+	if (!size || !strtoul(size, 0, 16))
+		return 0;
+	
+	return !objectFileIsDebug(name);
+}
+
+/**@brief Frees the collected sections and relocation tables.
+ * @param[in] src  object file to clear
+ */
+static void clear(objectFile* src)
+{
+	listStart(src->sects);
+	while (listNext(src->sects))
+		free(listGet(src->sects));
+	
+	listStart(src->tables);
+	while (listNext(src->tables))
+	{
+		objectFileTable* table = (objectFileTable*) listGet(src->tables);
+		
+		listStart(table->targets);
+		while (listNext(table->targets))
+			free(listGet(table->targets));
+		
+		listStart(table->types);
+		while (listNext(table->types))
+			free(listGet(table->types));
+		
+		deleteList(table->targets);
+		deleteList(table->offsets);
+		deleteList(table->types);
+		free(table->section);
+		free(table);
+	}
+	
+	deleteList(src->sects);
+	deleteList(src->sizes);
+	deleteList(src->aligns);
+	deleteList(src->tables);
+	src->pinned = 0;
+	src->sects = newList();
+	src->sizes = newList();
+	src->aligns = newList();
+	src->tables = newList();
+}
+
+/**@brief Records the state of the file of an object.
+ * @return \c 1, if it differs from the recorded one, else \c 0
+ */
+static int remember(objectFile* src, const struct stat* st)
+{
+	int res = st->st_mtime != src->mtime || SO_MTIME_NSEC(*st) != src->mtimeNsec
+	          || (long) st->st_size != src->size
+	          || (unsigned long) st->st_ino != src->inode
+	          || (unsigned long) st->st_dev != src->device;
+	
+	src->mtime = st->st_mtime;
+	src->mtimeNsec = SO_MTIME_NSEC(*st);
+	src->size = (long) st->st_size;
+	src->inode = (unsigned long) st->st_ino;
+	src->device = (unsigned long) st->st_dev;
+	
+	return res;
+}
+
 /**@brief Parses the relocation section of the generated object file.
- * @param[in] src   marks the node assigned to the section
- * @param[in] file  handle to the file
+ * @param[in]     table  receives the referenced symbols
+ * @param[in]     file   handle to the file
+ * @param[in,out] line   line buffer of getline(), lines may be arbitrarily
+ *                       long due to mangled names
+ * @param[in,out] size   size of the line buffer
  */
-static void parseRelocSection(graph* src, FILE* file)
+static void parseRelocSection(objectFileTable* table, FILE* file, char** line,
+                              size_t* size)
 {
-	static char buffer[256];
-	char *ptr, *token;
+	char *ptr, *token, *offset, *type, *save;
 	
-	while (!feof(file))
+	while (getline(line, size, file) > 0)
 	{
-		fgets(buffer, sizeof(buffer), file);
-		ptr = trim(buffer);
+		ptr = trim(*line);
 		
 		
 		/* a blank line quits the table */
 		if (!*ptr)
 			return;
 		
-		/* skip OFFSET */
-		token = strtok(ptr, " ");
-		/* skip TYPE */
-		token = strtok(0, " ");
+		/* remember OFFSET and TYPE, folding depends on them */
+		offset = strtok_r(ptr, " ", &save);
+		type = strtok_r(0, " ", &save);
 		
 		
 		/* process VALUE */
-		token = strtok(0, " ");
+		token = strtok_r(0, " ", &save);
 		
 		if (token)
 		{
-			graph* dest;
-			
-			
 			/* trim front-end */
 			if (*token == '_')
 				++token;
@@ -101,19 +223,15 @@ static void parseRelocSection(graph* src, FILE* file)
 			else if (*token == '@')
 			{
 				++token;
-				token = strtok(token, "@");
+				token = strtok_r(token, "@", &save);
 			}
 			/* check for various prefixes */
 			else
 			{
-				int i = SO_PREFIX_COUNT;
+				const char* key = objectFileKey(token);
 				
-				while (i--)
-					if (!strncmp(token, prefix[i], strlen(prefix[i])))
-					{
-						token += strlen(prefix[i]);
-						break;
-					}
+				if (key)
+					token += key - token;
 			}
 			
 			/* trim back-end */
@@ -131,83 +249,92 @@ static void parseRelocSection(graph* src, FILE* file)
 					*i = 0;
 			}
 			
-			dest = (graph*) hashmapGet(sectionMap, token);
-			
-			if (dest)
-			{
-				/* normal dependency spotted - link engaged */
-				if (src)
-					graphConnect(src, dest);
-				
-				/* dependency with unknown section spotted; we need to calculate its
-				 * dependencies as well, because this section will survive for sure
-				 */
-				else
-					listAdd(unknownSection, dest);
-			}
+			listAdd(table->targets, strdup(token));
+			listAdd(table->offsets, (void*) strtoul(offset, 0, 16));
+			listAdd(table->types, strdup(type));
 		}
 	}
 }
 
-/**@brief Colorizes a graph starting from a given seed.
- * @param[in] seed   initial node
- * @param[in] color  the color
- */
-static void colorizeGraph(graph* seed, unsigned long color)
-{
-	unsigned long c = graphGetColorNode(seed);
-	if ((c | color) != c)
-	{
-		list* depends = graphGetConnections(seed);
-		graphColorNode(seed, c | color);
-		
-		listStart(depends);
-		while (listNext(depends))
-			colorizeGraph((graph*) listGet(depends), color);
-	}
-}
-
 /* ******************************************************* exported functions */
 
 objectFile* objectFileCreate(const char* name)
 {
 	objectFile* res = (objectFile*) malloc(sizeof(objectFile));
 	
-	res->name = name;
+	res->name = strdup(name);
 	res->sects = newList();
+	res->sizes = newList();
+	res->aligns = newList();
+	res->tables = newList();
+	res->mtime = 0;
+	res->mtimeNsec = 0;
+	res->size = -1;
+	res->inode = 0;
+	res->device = 0;
+	res->stale = 1;
+	res->pinned = 0;
 	
 	return res;
 }
 
-void objectFileCollect(objectFile* src, FILE* file)
+void objectFileDelete(objectFile* src)
+{
+	clear(src);
+	
+	deleteList(src->sects);
+	deleteList(src->sizes);
+	deleteList(src->aligns);
+	deleteList(src->tables);
+	free(src->name);
+	free(src);
+}
+
+int objectFileCollect(list* objects, FILE* file, stats* st)
 {
 	unsigned long progress = 0;
-	char buffer[256], *ptr, *token;
+	char *line = 0, *ptr, *token, *save;
+	size_t size = 0;
+	objectFile* src = 0;
+	double begin = 0;
+	
+	listStart(objects);
 	
-	while (!feof(file))
+	while (getline(&line, &size, file) > 0)
 	{
-		fgets(buffer, sizeof(buffer), file);
-		ptr = trim(buffer);
+		ptr = trim(line);
 		
 		if (*ptr)
 		{
-			switch (progress)
+			/* the output of the next file begins */
+			if (strstr(ptr, "file format"))
 			{
-			case 0: /* search for the filename */
-				token = strtok(ptr, ":");
-				if (token && !strcmp(token, src->name))
-					progress = SO_FOUNDNAME;
-				break;
+				if (src)
+					statsSpan(st, "parse", src->name, 0, begin);
 				
+				begin = statsTime();
+				src = findStale(objects, ptr);
+				progress = 0;
 				
+				if (src)
+				{
+					clear(src);
+					src->stale = 0;
+					progress = SO_FOUNDNAME;
+				}
+				continue;
+			}
+			
+			switch (progress)
+			{
 			case SO_FOUNDNAME: /* search for the section keyword */
-				token = strtok(ptr, ":");
+				token = strtok_r(ptr, ":", &save);
 				if (token)
 				{
 					upper(token);
 					if (!strcmp(token, "SECTIONS"))
 					{
-						fgets(buffer, sizeof(buffer), file);
+						getline(&line, &size, file);
 						progress = SO_FOUNDSECTION;
 					}
 				}
@@ -215,293 +342,223 @@ void objectFileCollect(objectFile* src, FILE* file)
 				
 				
 			case SO_FOUNDSECTION: /* march through the section table */
-				token = strtok(ptr, " ");
-				
-				if (token)
+				if (strncmp(ptr, "RELOCATION", sizeof("RELOCATION") - 1))
 				{
-					token = strtok(0, " ");
+					token = strtok_r(ptr, " ", &save);
+					
 					if (token)
 					{
-						int i = SO_PREFIX_COUNT;
-						
+						token = strtok_r(0, " ", &save);
 						
 						/* lookout for various prefixes */
-						while (i--)
-							if (!strncmp(token, prefix[i], strlen(prefix[i])))
-							{
-								listAdd(src->sects, strdup(token));
-								break;
-							}
+						if (token && objectFileKey(token))
+						{
+							char* size = strtok_r(0, " ", &save);
+							char* align = 0;
+							int i = 0;
+							
+							/* skip VMA, LMA and the file offset */
+							while (++i <= 4 && (align = strtok_r(0, " ", &save)));
+							
+							/* alignment is printed as a power of two (2**n) */
+							align = (align) ? strstr(align, "**") : 0;
+							
+							listAdd(src->sects, strdup(token));
+							listAdd(src->sizes,
+							        (void*) ((size) ? strtoul(size, 0, 16) : 0));
+							listAdd(src->aligns,
+							        (void*) (1UL << ((align) ? atoi(align + 2) : 0)));
+						}
+						else if (token)
+							src->pinned += isPinned(token, strtok_r(0, " ", &save));
 					}
+					break;
 				}
-			}
-		}
-		/* a blank line indicates the end of the section table */
-		else if (progress == SO_FOUNDSECTION)
-			return;
-	}
-}
-
-void objectFileCompute(list* oFiles, FILE* file)
-{
-	objectFile* cFile;
-	
-	/* check for older runs... just to be clean */
-	if (sectionMap)
-		deleteHashmap(sectionMap);
-	if (unknownSection)
-		deleteList(unknownSection);
-	
-	sectionMap = newHashmap(8);
-	unknownSection = newList();
-	
-	
-	/* insert all functions and data */
-	listStart(oFiles);
-	while (listNext(oFiles))
-	{
-		cFile = (objectFile*) listGet(oFiles);
-		if (!listIsEmpty(cFile->sects))
-		{
-			listStart(cFile->sects);
-			while (listNext(cFile->sects))
-			{
-				char *token, *ptr;
-				int i = SO_PREFIX_COUNT;
-				ptr = token = (char*) listGet(cFile->sects);
 				
-				/* skip the prefix for key generation
-				 (needed when reading the relocation table)*/
-				while (i--)
-					if (!strncmp(token, prefix[i], strlen(prefix[i])))
-					{
-						ptr += strlen(prefix[i]);
-						listSet(cFile->sects, ptr);
-						break;
-					}
+				/* some versions of objdump don't separate the tables */
+				progress = SO_FOUNDRELOCS;
+				/* fall through */
 				
-				/* test if the entry already exists */
-				if (!hashmapGet(sectionMap, ptr))
-					hashmapSet(sectionMap, newGraph(token), ptr);
-			}
-		}
-	}
-	
-	/* parse the file */
-	{
-		char buffer[256], *ptr, *token;
-		graph* cGraph;
-		
-		while (!feof(file))
-		{
-			ParseLoop: fgets(buffer, sizeof(buffer), file);
-			ptr = trim(buffer);
-			
-			if (*ptr)
-			{
-				token = strtok(ptr, ":");
-				if (token)
+			case SO_FOUNDRELOCS: /* look for the relocation keyword */
+				if (!strncmp(ptr, "RELOCATION", sizeof("RELOCATION") - 1))
 				{
-					/* look for the relocation keyword */
-					if (!strncmp(token, "RELOCATION", sizeof("RELOCATION") - 1))
+					objectFileTable* table;
+					const char* key;
+					
+					/* get the name */
+					token = ptr + sizeof("RELOCATION");
+					while (*token && *token++ != '[');
+					
+					/* we could easily search for the '$', but that would create
+					 more dependencies to the compilers naming conventions */
+					if (*token && (key = objectFileKey(token)))
+						token += key - token;
+					
+					token = strtok_r(token, "]", &save);
+					
+					
+					/* just to be sure */
+					if (!token || !*token)
 					{
-						int i;
-						
-						/* get the name */
-						token += sizeof("RELOCATION");
-						while (*token && *token++ != '[');
-						
-						/* just to be sure */
-						if (!*token)
-						{
-							fprintf(stderr, "ERROR: file with relocation table "
-								"has invalid format!\n");
-							return;
-						}
-						
-						/* we could easily search for the '$', but that would create
-						 more dependencies to the compilers naming conventions */
-						i = SO_PREFIX_COUNT;
-						while (i--)
-							if (!strncmp(token, prefix[i], strlen(prefix[i])))
-							{
-								token += strlen(prefix[i]);
-								break;
-							}
-						
-						token = strtok(token, "]");
-						
-						
-						/* just to be sure */
-						if (!token)
-						{
-							fprintf(stderr, "ERROR: file with relocation table "
-							        "has invalid format!\n");
-							return;
-						}
-						
-						cGraph = (graph*) hashmapGet(sectionMap, token);
-						
-						if (!cGraph)
-						{
-							/* test for weak sections */
-							i = SO_WEAK_COUNT;
-							while (i--)
-								if (!strcmp(token, weak[i]))
-									goto ParseLoop;
-						}
-						
-						/* skip the tables caption */
-						fgets(buffer, sizeof(buffer), file);
-						
-						parseRelocSection(cGraph, file);
+						fprintf(stderr, "ERROR: file with relocation table "
+						        "has invalid format!\n");
+						free(line);
+						return 0;
 					}
+					
+					table = (objectFileTable*) malloc(sizeof(objectFileTable));
+					table->section = strdup(token);
+					table->targets = newList();
+					table->offsets = newList();
+					table->types = newList();
+					listAdd(src->tables, table);
+					
+					/* skip the tables caption */
+					getline(&line, &size, file);
+					
+					parseRelocSection(table, file, &line, &size);
 				}
 			}
 		}
+		/* a blank line indicates the end of the section table */
+		else if (progress == SO_FOUNDSECTION)
+			progress = SO_FOUNDRELOCS;
 	}
 	
-	/* colorize the unknown section dependencies */
+	if (src)
+		statsSpan(st, "parse", src->name, 0, begin);
 	
-	/* this part may be optimized a bit by calculating their dependencies
-	 * as well, but I'm unsure if that wouldn't be too aggressive, removing
-	 * sections that may be needed somehow (when the linker adds code to the
-	 * final exe for example), so I left them in to be sure
-	 */
-	listStart(unknownSection);
-	while (listNext(unknownSection))
-		colorizeGraph((graph*) listGet(unknownSection), 0x80000000);
+	free(line);
+	return 1;
 }
 
-void objectFileColorize(const char* seed, unsigned long color)
+void objectFileAddSection(objectFile* src, const char* name,
+                          unsigned long size, unsigned long align)
 {
-	graph* start = (graph*) hashmapGet(sectionMap, seed);
+	/* append to the lists */
+	while (listNext(src->sects));
+	while (listNext(src->sizes));
+	while (listNext(src->aligns));
 	
-	if (start)
-		colorizeGraph(start, color);
+	listAdd(src->sects, strdup(name));
+	listAdd(src->sizes, (void*) size);
+	listAdd(src->aligns, (void*) align);
+	src->stale = 0;
 }
 
-list* objectFileGetUsed(objectFile* src)
+void objectFileAddReference(objectFile* src, const char* section,
+                            const char* target)
 {
-	list* res = newList();
+	objectFileTable* table;
 	
-	listStart(src->sects);
-	while (listNext(src->sects))
+	while (listNext(src->tables));
+	table = (objectFileTable*) listGet(src->tables);
+	
+	if (!table || strcmp(table->section, section))
 	{
-		char* name = (char*) listGet(src->sects);
-		graph* curr = (graph*) hashmapGet(sectionMap, name);
-		
-		if (graphGetColorNode(curr))
-			listAdd(res, graphGetNameNode(curr));
+		table = (objectFileTable*) malloc(sizeof(objectFileTable));
+		table->section = strdup(section);
+		table->targets = newList();
+		table->offsets = newList();
+		table->types = newList();
+		listAdd(src->tables, table);
 	}
 	
-	return res;
+	/* maps don't record where and how a section references */
+	while (listNext(table->targets));
+	while (listNext(table->offsets));
+	while (listNext(table->types));
+	
+	listAdd(table->targets, strdup(target));
+	listAdd(table->offsets, 0);
+	listAdd(table->types, strdup(""));
+}
+
+const char* objectFileGetName(objectFile* src)
+{
+	return src->name;
+}
+
+list* objectFileGetSections(objectFile* src)
+{
+	return src->sects;
+}
+
+list* objectFileGetSizes(objectFile* src)
+{
+	return src->sizes;
 }
 
-list* objectFileGetUnused(objectFile* src)
+list* objectFileGetAlignments(objectFile* src)
 {
-	list* res = newList();
+	return src->aligns;
+}
+
+list* objectFileGetTables(objectFile* src)
+{
+	return src->tables;
+}
+
+int objectFileIsStale(objectFile* src)
+{
+	return src->stale;
+}
+
+int objectFileIsPinned(objectFile* src)
+{
+	return src->pinned != 0;
+}
+
+int objectFileRefresh(objectFile* src)
+{
+	struct stat st;
 	
-	listStart(src->sects);
-	while (listNext(src->sects))
-	{
-		char* name = (char*) listGet(src->sects);
-		graph* curr = (graph*) hashmapGet(sectionMap, name);
-		
-		if (!graphGetColorNode(curr))
-			listAdd(res, graphGetNameNode(curr));
-	}
+	/* a rebuild within the same second may keep the size, but rarely also
+	 the nanoseconds and the inode */
+	if (stat(src->name, &st) || remember(src, &st))
+		src->stale = 1;
 	
-	return res;
+	return src->stale;
 }
 
-const char* objectFileGetName(objectFile* src)
+void objectFileTouch(objectFile* src)
 {
-	return src->name;
+	struct stat st;
+	
+	if (!stat(src->name, &st))
+		remember(src, &st);
 }
 
-void objectFileDumpMap(list* oFiles)
+const char* objectFileKey(const char* section)
 {
-	/* yay ^_^, what a loop */
-	printf("\n<MAP>\n");
-	listStart(oFiles);
-	while (listNext(oFiles))
-	{
-		objectFile* oFile = (objectFile*) listGet(oFiles);
-		printf("\t<FILE name=\"%s\">\n", oFile->name);
-		fflush(stdout);
-		
-		listStart(oFile->sects);
-		while (listNext(oFile->sects))
-		{
-			char* name = (char*) listGet(oFile->sects);
-			graph* sect = (graph*) hashmapGet(sectionMap, name);
-			list* depend = graphGetConnections(sect);
-			
-			printf("\t\t<SECTION name=\"%s\" color=\"%lu\">\n",
-			       (char*) graphGetNameNode(sect), graphGetColorNode(sect));
-			fflush(stdout);
-			
-			listStart(depend);
-			while (listNext(depend))
-			{
-				graph* d = (graph*) listGet(depend);
-				printf("\t\t\t<DEPENDS>%s</DEPENDS>\n", (char*) graphGetNameNode(d));
-				fflush(stdout);
-			}
-			
-			printf("\t\t</SECTION>\n");
-			fflush(stdout);
-		}
-		printf("\t</FILE>\n");
-		fflush(stdout);
-	}
-	printf("\n</MAP>\n");
-	fflush(stdout);
+	int i = SO_PREFIX_COUNT;
+	
+	while (i--)
+		if (!strncmp(section, prefix[i], strlen(prefix[i])))
+			return section + strlen(prefix[i]);
+	
+	/* associated sections share their name with the parent */
+	return (objectFileParent(section)) ? section : 0;
 }
 
-void objectFileDumpUsed(list* oFiles)
+const char* objectFileParent(const char* section)
 {
-	printf("\n<USED>\n");
+	int i = SO_ASSOC_COUNT;
 	
-	listStart(oFiles);
-	while (listNext(oFiles))
-	{
-		objectFile* obj = (objectFile*) listGet(oFiles);
-		list* curr = objectFileGetUsed(obj);
-		
-		printf("\t<FILE name=\"%s\">\n", obj->name);
-		
-		listStart(curr);
-		while (listNext(curr))
-			printf("\t\t<SECTION>%s</SECTION>\n", (char*) listGet(curr));
-		
-		deleteList(curr);
-		
-		printf("\t</FILE>\n");
-	}
-	printf("</USED>\n");
+	while (i--)
+		if (!strncmp(section, assoc[i], strlen(assoc[i])))
+			return section + strlen(assoc[i]);
+	
+	return 0;
 }
 
-void objectFileDumpUnused(list* oFiles)
+int objectFileIsDebug(const char* section)
 {
-	printf("\n<UNUSED>\n");
+	int i = SO_SAFE_COUNT;
 	
-	listStart(oFiles);
-	while (listNext(oFiles))
-	{
-		objectFile* obj = (objectFile*) listGet(oFiles);
-		list* curr = objectFileGetUnused(obj);
-		
-		printf("\t<FILE name=\"%s\">\n", obj->name);
-		
-		listStart(curr);
-		while (listNext(curr))
-			printf("\t\t<SECTION>%s</SECTION>\n", (char*) listGet(curr));
-		
-		deleteList(curr);
-		
-		printf("\t</FILE>\n");
-	}
-	printf("</UNUSED>\n");
+	while (i--)
+		if (!strncmp(section, safe[i], strlen(safe[i])))
+			return 1;
+	
+	return 0;
 }
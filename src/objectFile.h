@@ -11,50 +11,135 @@
 
 #include <stdio.h>
 #include "list.h"
+#include "stats.h"
 
 /* forward declaration of opaque structure */
 struct s_objectFile;
 typedef struct s_objectFile objectFile;
 
-/**@brief Creates a new object file and returns a pointer to it.
+/**@brief Relocations of a single section.
  */
-extern objectFile* objectFileCreate(const char* name);
+typedef struct
+{
+	char* section; /**< Key of the section that contains the relocations. */
+	list* targets; /**< Keys of the referenced symbols and sections. */
+	list* offsets; /**< Offsets of the relocations within the section. */
+	list* types; /**< Types of the relocations, like \c dir32. */
+} objectFileTable;
 
-/**@brief Collects all the sections from a objdump generated file.
+/**@brief Creates a new object file and returns a pointer to it.
+ * @note The name is copied.
  */
-extern void objectFileCollect(objectFile* src, FILE* file);
+extern objectFile* objectFileCreate(const char* name);
 
-/**@brief Computes the dependencies between the various sections of the objects.
+/**@brief Frees the object file together with its section list.
  */
-extern void objectFileCompute(list* oFiles, FILE* file);
+extern void objectFileDelete(objectFile* src);
 
-/**@brief Recursively colorizes the dependency graph starting with seed. Two
- * colors get mixed using binary OR.
+/**@brief Collects the sections and relocation tables of all stale objects
+ * from a objdump generated file.
+ * @note Objects that aren't mentioned in the file stay stale.
+ *
+ * @param[in] objects  list of object files
+ * @param[in] file     output of <tt>objdump -rh</tt>
+ * @param[in] st       statistics that trace the parsing of every object, may
+ *                     be \c NULL
+ * @return \c 1 on success, \c 0 if the file has an invalid format
  */
-extern void objectFileColorize(const char* seed, unsigned long color);
+extern int objectFileCollect(list* objects, FILE* file, stats* st);
 
-/**@brief Returns a list containing all used sections.
+/**@brief Adds a section by hand, e.g. when replaying a saved map. The
+ * object doesn't count as stale anymore.
+ *
+ * @param[in] src    object file
+ * @param[in] name   section name, which is copied
+ * @param[in] size   size in bytes
+ * @param[in] align  alignment in bytes
  */
-extern list* objectFileGetUsed(objectFile* src);
+extern void objectFileAddSection(objectFile* src, const char* name,
+                                 unsigned long size, unsigned long align);
 
-/**@brief Returns a list containing all unused sections.
+/**@brief Adds a relocation by hand, consecutive ones of the same section end
+ * up in the same table.
+ *
+ * @param[in] src      object file
+ * @param[in] section  key of the referencing section, which is copied
+ * @param[in] target   key of the referenced symbol or section, which is
+ *                     copied
+ * @note The relocation gets offset \c 0 and an empty type.
  */
-extern list* objectFileGetUnused(objectFile* src);
+extern void objectFileAddReference(objectFile* src, const char* section,
+                                   const char* target);
 
 /**@brief Returns the name of the given object file.
  */
 extern const char* objectFileGetName(objectFile* src);
 
-/**@brief Dumps the dependency graph XML-like formatted to stdout.
+/**@brief Returns the list of collected section names.
+ * @note The list is owned by the object file.
+ */
+extern list* objectFileGetSections(objectFile* src);
+
+/**@brief Returns the sizes of the collected sections in bytes.
+ * @note The list is owned by the object file. It's parallel to the one of
+ * objectFileGetSections() and stores the sizes as <tt>unsigned long</tt>
+ * values casted to pointers.
+ */
+extern list* objectFileGetSizes(objectFile* src);
+
+/**@brief Returns the alignments of the collected sections in bytes.
+ * @note The list is owned by the object file. It's parallel to the one of
+ * objectFileGetSections() and stores the alignments like
+ * objectFileGetSizes() does.
+ */
+extern list* objectFileGetAlignments(objectFile* src);
+
+/**@brief Returns the list of collected relocation tables.
+ * @note The list and its tables are owned by the object file.
+ */
+extern list* objectFileGetTables(objectFile* src);
+
+/**@brief Returns \c 1, if the sections and relocations of the object have to
+ * be collected (again), else \c 0.
+ */
+extern int objectFileIsStale(objectFile* src);
+
+/**@brief Returns \c 1, if the object has sections without a known prefix
+ * that carry more than debug information, else \c 0.
+ * @note Such objects have to be linked, even if none of their known sections
+ * is used.
+ */
+extern int objectFileIsPinned(objectFile* src);
+
+/**@brief Compares modification time (with nanoseconds, where available),
+ * size and inode of the file with the ones seen at the last refresh and marks
+ * the object stale, if they differ.
+ * @return \c 1, if the object is stale, else \c 0
+ */
+extern int objectFileRefresh(objectFile* src);
+
+/**@brief Records modification time, size and inode of the file without
+ * marking the object stale, e.g. after the file got stripped.
+ */
+extern void objectFileTouch(objectFile* src);
+
+/**@brief Returns the key of a section name, i.e. the name without its known
+ * prefix, or \c NULL, if the section doesn't carry one of those prefixes.
+ * @note Associated sections are keyed by their full name, since their key
+ * would clash with the one of their parent.
  */
-extern void objectFileDumpMap(list* oFiles);
+extern const char* objectFileKey(const char* section);
 
-/**@brief Dumps the used sections in XML-like formatted to stdout.
+/**@brief Returns the key of the parent of an associated section, like the
+ * unwind information in <tt>.pdata$</tt> and <tt>.xdata$</tt> sections, or
+ * \c NULL, if the section isn't associated with a function.
+ * @note An associated section is needed exactly when its parent is.
  */
-extern void objectFileDumpUsed(list* oFiles);
+extern const char* objectFileParent(const char* section);
 
-/**@brief Dumps the unused sections in XML format to stdout.
+/**@brief Returns \c 1, if a section only carries debug information or
+ * comments, else \c 0.
  */
-extern void objectFileDumpUnused(list* oFiles);
+extern int objectFileIsDebug(const char* section);
 
 #endif
@@ -0,0 +1,97 @@
+/***************************************************************************//**
+ * @file parallel.c
+ * @author Dorian Weber
+ * @brief Implementation of the parallel loop.
+ ******************************************************************************/
+
+#include "parallel.h"
+
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* *************************************************************** structures */
+
+/**@brief Share of the items processed by a thread.
+ */
+typedef struct
+{
+	size_t begin; /**< First item. */
+	size_t end; /**< Item after the last one. */
+	fParallelProc proc; /**< Processing function. */
+	void* arg; /**< Argument of the function. */
+} job;
+
+/* ******************************************************** private functions */
+
+/**@brief Processes the items of a job.
+ */
+static void* work(void* arg)
+{
+	job* j = (job*) arg;
+	
+	if (j->begin < j->end)
+		j->proc(j->arg, j->begin, j->end);
+	
+	return 0;
+}
+
+/* ******************************************************* exported functions */
+
+void parallelFor(size_t count, int threads, fParallelProc proc, void* arg)
+{
+	job* jobs;
+	size_t share;
+	int i;
+
+#ifndef _WIN32
+	pthread_t* ids;
+	char* started;
+	
+	if (threads <= 0)
+		threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	if (threads <= 0 || (size_t) threads > count)
+		threads = 1;
+	
+	jobs = (job*) malloc(sizeof(job) * threads);
+	share = (count + threads - 1) / threads;
+	
+	for (i = 0; i < threads; ++i)
+	{
+		size_t begin = share * i, end = begin + share;
+		
+		jobs[i].begin = (begin < count) ? begin : count;
+		jobs[i].end = (end < count) ? end : count;
+		jobs[i].proc = proc;
+		jobs[i].arg = arg;
+	}
+
+#ifndef _WIN32
+	ids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+	started = (char*) calloc(threads, 1);
+	
+	/* a share gets processed right away, if its thread can't be started */
+	for (i = 1; i < threads; ++i)
+		if (!(started[i] = !pthread_create(ids + i, 0, work, jobs + i)))
+			work(jobs + i);
+	
+	work(jobs);
+	
+	for (i = 1; i < threads; ++i)
+		if (started[i])
+			pthread_join(ids[i], 0);
+	
+	free(started);
+	free(ids);
+#else
+	for (i = 0; i < threads; ++i)
+		work(jobs + i);
+#endif
+
+	free(jobs);
+}
@@ -0,0 +1,36 @@
+/***************************************************************************//**
+ * @file parallel.h
+ * @author Dorian Weber
+ * @brief Interface of a simple parallel loop.
+ * 
+ * The items are split into equal shares, one per thread, and the calling
+ * thread takes the first share. Without POSIX threads, all shares are
+ * processed one after another.
+ * 
+ * @sa parallel.c
+ ******************************************************************************/
+
+#ifndef PARALLEL_H_INCLUDED
+#define PARALLEL_H_INCLUDED
+
+#include <stddef.h>
+
+/**@brief Prototype of a function that processes a range of items.
+ * @param[in] arg    argument passed to parallelFor()
+ * @param[in] begin  index of the first item
+ * @param[in] end    index behind the last item
+ */
+typedef void(*fParallelProc)(void* arg, size_t begin, size_t end);
+
+/**@brief Processes items in several threads and waits for all of them.
+ * @note The function has to be safe to run concurrently on disjoint ranges.
+ * 
+ * @param[in] count    number of items
+ * @param[in] threads  number of threads, \c 0 for one per processor
+ * @param[in] proc     processing function
+ * @param[in] arg      argument passed to the function
+ */
+extern void parallelFor(size_t count, int threads, fParallelProc proc,
+                        void* arg);
+
+#endif
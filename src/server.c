@@ -0,0 +1,349 @@
+/***************************************************************************//**
+ * @file server.c
+ * @author Dorian Weber
+ * @brief Implementation of the resident analysis server and its client.
+ ******************************************************************************/
+
+#include "server.h"
+#include "deadstrip.h"
+#include "driver.h"
+#include "hashmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+/* *************************************************************** structures */
+
+#define SO_STATUS  '\036'  /**<@brief Separates the output from the status. */
+#define SO_PATHLEN 4096    /**<@brief Maximum length of a working directory. */
+
+#ifndef _WIN32
+
+/* ******************************************************** private functions */
+
+/**@brief Frees the analysis context of a target.
+ */
+static void dropTarget(const char* key, const void* datum)
+{
+	(void) key;
+	deleteDeadstrip((deadstrip*) datum);
+}
+
+/**@brief Returns the key of a target, which is the absolute name of the
+ * linked file.
+ * @note The caller has to free the key.
+ */
+static char* targetKey(const char* cwd, const char* output)
+{
+	char* res = (char*) malloc(strlen(cwd) + strlen(output) + 2);
+	
+	if (*output == '/')
+		strcpy(res, output);
+	else
+		sprintf(res, "%s/%s", cwd, output);
+	
+	return res;
+}
+
+/**@brief Returns the name of the linked file from a command line.
+ */
+static const char* findOutput(int argc, char* argv[])
+{
+	int i;
+	
+	for (i = 0; i < argc; ++i)
+		if (!strncmp(argv[i], "-o", sizeof("-o") - 1))
+		{
+			if (argv[i][sizeof("-o") - 1])
+				return argv[i] + sizeof("-o") - 1;
+			if (i + 1 < argc)
+				return argv[i + 1];
+		}
+	
+	return 0;
+}
+
+/**@brief Reads and answers a single request.
+ * @param[in] targets  maps target keys to their analysis contexts
+ * @param[in] client   connected socket, which gets closed
+ * @param[in] home     working directory to return to afterwards
+ * @return \c 0, if the server should stop, else \c 1
+ */
+static int handle(hashmap* targets, int client, const char* home)
+{
+	FILE *in = fdopen(client, "r"), *out = 0;
+	char *line = 0, **args = 0, *key = 0;
+	size_t size = 0;
+	int count = 0, res = -1, running = 1, copy = dup(client);
+	ssize_t len;
+	
+	if (copy >= 0 && !(out = fdopen(copy, "w")))
+		close(copy);
+	
+	/* a client that can't be answered doesn't stop the others */
+	if (!in || !out)
+	{
+		fprintf(stderr, "ERROR: can't answer a request.\n");
+		
+		if (in)
+			fclose(in);
+		else
+			close(client);
+		if (out)
+			fclose(out);
+		
+		return 1;
+	}
+	
+	/* read all lines up to the empty one */
+	while ((len = getline(&line, &size, in)) > 0)
+	{
+		if (line[len - 1] == '\n')
+			line[--len] = 0;
+		if (!len)
+			break;
+		
+		args = (char**) realloc(args, sizeof(char*) * (count + 1));
+		args[count++] = strdup(line);
+	}
+	free(line);
+	
+	if (count < 2)
+		fprintf(out, "ERROR: incomplete request\n");
+	else if (chdir(args[1]))
+		fprintf(out, "ERROR: can't change to %s\n", args[1]);
+	else if (!strcmp(args[0], "link"))
+	{
+		const char* output = findOutput(count - 2, args + 2);
+		
+		if (output)
+		{
+			deadstrip* ds;
+			
+			key = targetKey(args[1], output);
+			ds = (deadstrip*) hashmapGet(targets, key);
+			
+			if (!ds)
+			{
+				ds = newDeadstrip();
+				hashmapSet(targets, ds, key);
+			}
+			
+			/* the working directory takes the place of the program name */
+			free(args[1]);
+			args[1] = strdup("deadstrip");
+			res = driverRun(ds, count - 1, (const char**) args + 1, out, out);
+		}
+		else
+			fprintf(out, "ERROR: the request doesn't name an output file\n");
+	}
+	else if (!strcmp(args[0], "query") && count > 2)
+	{
+		deadstrip* ds;
+		
+		key = targetKey(args[1], args[2]);
+		ds = (deadstrip*) hashmapGet(targets, key);
+		
+		if (ds)
+		{
+			int i;
+			
+			for (i = 3; i < count; ++i)
+				fprintf(out, "%s %lu\n", args[i], deadstripGetColor(ds, args[i]));
+			res = 0;
+		}
+		else
+			fprintf(out, "ERROR: unknown target %s\n", args[2]);
+	}
+	else if (!strcmp(args[0], "drop") && count > 2)
+	{
+		deadstrip* ds;
+		
+		key = targetKey(args[1], args[2]);
+		ds = (deadstrip*) hashmapRemove(targets, key);
+		
+		if (ds)
+			deleteDeadstrip(ds);
+		res = 0;
+	}
+	else if (!strcmp(args[0], "stop"))
+	{
+		running = 0;
+		res = 0;
+	}
+	else
+		fprintf(out, "ERROR: unknown request %s\n", args[0]);
+	
+	/* relative paths of the server, e.g. its socket, stay valid */
+	if (chdir(home))
+		fprintf(stderr, "ERROR: can't return to %s.\n", home);
+	
+	fprintf(out, "%c%d\n", SO_STATUS, res);
+	
+	while (count--)
+		free(args[count]);
+	
+	free(args);
+	free(key);
+	fclose(out);
+	fclose(in);
+	
+	return running;
+}
+
+/* ******************************************************* exported functions */
+
+int serverRun(const char* path)
+{
+	struct sockaddr_un addr;
+	char home[SO_PATHLEN];
+	hashmap* targets;
+	int fd, running = 1;
+	
+	if (strlen(path) >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr, "ERROR: socket name %s is too long.\n", path);
+		return -1;
+	}
+	
+	if (!getcwd(home, sizeof(home)))
+	{
+		fprintf(stderr, "ERROR: can't determine the working directory.\n");
+		return -1;
+	}
+	
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(path);
+	
+	if (fd < 0 || bind(fd, (struct sockaddr*) &addr, sizeof(addr))
+	    || listen(fd, 16))
+	{
+		fprintf(stderr, "ERROR: can't listen on %s.\n", path);
+		return -1;
+	}
+	
+	/* clients that hang up early shouldn't kill the server */
+	signal(SIGPIPE, SIG_IGN);
+	targets = newHashmap(8);
+	
+	while (running)
+	{
+		int client = accept(fd, 0, 0);
+		
+		if (client >= 0)
+			running = handle(targets, client, home);
+		else if (errno != EINTR)
+			break;
+	}
+	
+	hashmapProcess(targets, dropTarget);
+	deleteHashmap(targets);
+	close(fd);
+	unlink(path);
+	
+	return running ? -1 : 0;
+}
+
+int serverRequest(const char* path, int argc, const char* argv[])
+{
+	struct sockaddr_un addr;
+	char cwd[SO_PATHLEN], *line = 0;
+	size_t size = 0;
+	int fd, res = -1;
+	FILE *in, *out;
+	
+	if (strlen(path) >= sizeof(addr.sun_path) || !getcwd(cwd, sizeof(cwd)))
+		return -1;
+	
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	
+	if (fd < 0 || connect(fd, (struct sockaddr*) &addr, sizeof(addr)))
+	{
+		fprintf(stderr, "ERROR: can't connect to %s.\n", path);
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	
+	in = fdopen(fd, "r");
+	out = ((res = dup(fd)) >= 0) ? fdopen(res, "w") : 0;
+	
+	if (!in || !out)
+	{
+		fprintf(stderr, "ERROR: can't talk to %s.\n", path);
+		
+		if (in)
+			fclose(in);
+		else
+			close(fd);
+		if (out)
+			fclose(out);
+		else if (res >= 0)
+			close(res);
+		
+		return -1;
+	}
+	
+	res = -1;
+	
+	/* send the request */
+	fprintf(out, "%s\n%s\n", *argv, cwd);
+	while (--argc)
+		fprintf(out, "%s\n", *++argv);
+	fprintf(out, "\n");
+	fflush(out);
+	
+	/* print the response */
+	while (getline(&line, &size, in) > 0)
+	{
+		char* status = strchr(line, SO_STATUS);
+		
+		if (status)
+		{
+			*status = 0;
+			res = atoi(status + 1);
+		}
+		fputs(line, stdout);
+	}
+	
+	free(line);
+	fclose(out);
+	fclose(in);
+	
+	return res;
+}
+
+#else
+
+int serverRun(const char* path)
+{
+	(void) path;
+	fprintf(stderr, "ERROR: the server isn't supported on this platform.\n");
+	return -1;
+}
+
+int serverRequest(const char* path, int argc, const char* argv[])
+{
+	(void) path, (void) argc, (void) argv;
+	fprintf(stderr, "ERROR: the server isn't supported on this platform.\n");
+	return -1;
+}
+
+#endif
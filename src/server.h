@@ -0,0 +1,42 @@
+/***************************************************************************//**
+ * @file server.h
+ * @author Dorian Weber
+ * @brief Interface of the resident analysis server and its client.
+ * 
+ * The server keeps one analysis context per linked target in memory, so
+ * relinking a target only dumps the objects that changed since the last time.
+ * It listens on a unix domain socket and handles one request at a time.
+ * 
+ * A request consists of lines and is terminated by an empty line:
+ * the command, the working directory of the client and one line for each
+ * argument. The server answers with the output of the command, followed by
+ * an ASCII record separator and the exit status.
+ * 
+ * Commands:
+ * \li \c link: the arguments are a regular deadstrip command line
+ * \li \c query: the first argument names the linked target (the file passed
+ *     with \c -o), all others are keys of sections whose colors are printed
+ * \li \c drop: forgets the target named by the first argument
+ * \li \c stop: shuts the server down
+ * 
+ * @sa server.c
+ ******************************************************************************/
+
+#ifndef SERVER_H_INCLUDED
+#define SERVER_H_INCLUDED
+
+/**@brief Serves requests on a unix domain socket until it's told to stop.
+ * @param[in] path  file name of the socket
+ * @return \c 0 after a stop request, \c -1 on failure
+ */
+extern int serverRun(const char* path);
+
+/**@brief Sends a request to a running server and prints its response.
+ * @param[in] path  file name of the socket
+ * @param[in] argc  number of arguments, including the command
+ * @param[in] argv  command followed by its arguments
+ * @return exit status of the request, \c -1 if the server can't be reached
+ */
+extern int serverRequest(const char* path, int argc, const char* argv[]);
+
+#endif
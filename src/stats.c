@@ -0,0 +1,363 @@
+/***************************************************************************//**
+ * @file stats.c
+ * @author Dorian Weber
+ * @brief Implementation of the run statistics.
+ ******************************************************************************/
+
+#include "stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+/* *************************************************************** structures */
+
+/**@brief Point in time, measured by all clocks.
+ */
+typedef struct
+{
+	double wall; /**< Elapsed time. */
+	double cpu; /**< CPU time of the process. */
+	double children; /**< CPU time of the finished subprocesses. */
+} instant;
+
+/**@brief Accumulated times of a phase or value of a counter.
+ */
+typedef struct
+{
+	const char* name; /**< Name of the phase or counter. */
+	instant time; /**< Times spent in the phase. */
+	unsigned long value; /**< Value of the counter. */
+} entry;
+
+/**@brief Growable array of entries.
+ */
+typedef struct
+{
+	entry* data; /**< The entries. */
+	size_t count, /**< Number of entries. */
+	       size; /**< Capacity of the array. */
+} entryArray;
+
+/**@brief Statistics of a run.
+ */
+struct s_stats
+{
+	instant start; /**< Start of the run. */
+	instant phaseStart; /**< Start of the current phase. */
+	entry* phase; /**< Current phase, \c NULL between phases. */
+	entryArray phases; /**< Phases in the order they were entered first. */
+	entryArray counters; /**< Counters in the order they were added first. */
+	FILE* trace; /**< Destination of trace events, \c NULL if not traced. */
+	unsigned long events; /**< Number of written trace events. */
+#ifndef _WIN32
+	pthread_mutex_t lock; /**< Serializes the trace events. */
+#endif
+};
+
+/* ******************************************************** private functions */
+
+/**@brief Reads all clocks.
+ */
+static void now(instant* dest)
+{
+#ifndef _WIN32
+	struct rusage self, children;
+	
+	getrusage(RUSAGE_SELF, &self);
+	getrusage(RUSAGE_CHILDREN, &children);
+	
+	dest->wall = statsTime();
+	dest->cpu = self.ru_utime.tv_sec + self.ru_utime.tv_usec * 1e-6
+	            + self.ru_stime.tv_sec + self.ru_stime.tv_usec * 1e-6;
+	dest->children = children.ru_utime.tv_sec + children.ru_utime.tv_usec * 1e-6
+	                 + children.ru_stime.tv_sec + children.ru_stime.tv_usec * 1e-6;
+#else
+	/* lacking getrusage, the wall time has to do */
+	dest->wall = dest->cpu = statsTime();
+	dest->children = 0;
+#endif
+}
+
+/**@brief Returns the number of the calling thread, as shown in traces.
+ */
+static unsigned long thread()
+{
+#if defined(__linux__)
+	return (unsigned long) syscall(SYS_gettid);
+#elif !defined(_WIN32)
+	return (unsigned long) pthread_self();
+#else
+	return 0;
+#endif
+}
+
+/**@brief Writes a JSON string.
+ */
+static void quote(FILE* out, const char* src)
+{
+	fputc('"', out);
+	
+	for (; *src; ++src)
+	{
+		if (*src == '"' || *src == '\\')
+			fputc('\\', out);
+		else if ((unsigned char) *src < ' ')
+		{
+			fprintf(out, "\\u%04x", *src);
+			continue;
+		}
+		
+		fputc(*src, out);
+	}
+	
+	fputc('"', out);
+}
+
+/**@brief Writes a complete trace event.
+ * @note The caller has to hold the lock.
+ */
+static void event(stats* src, const char* category, const char* name,
+                  const char* detail, double begin, double end)
+{
+	fprintf(src->trace, "%s\n{\"ph\":\"X\",\"cat\":", (src->events++) ? "," : "");
+	quote(src->trace, category);
+	fprintf(src->trace, ",\"name\":");
+	quote(src->trace, name);
+	fprintf(src->trace, ",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu",
+	        (begin - src->start.wall) * 1e6, (end - begin) * 1e6,
+#ifndef _WIN32
+	        (unsigned long) getpid(),
+#else
+	        0UL,
+#endif
+	        thread());
+	
+	if (detail)
+	{
+		fprintf(src->trace, ",\"args\":{\"detail\":");
+		quote(src->trace, detail);
+		fprintf(src->trace, "}");
+	}
+	
+	fprintf(src->trace, "}");
+}
+
+/**@brief Returns the entry of a name and creates it, if necessary.
+ * @note Entries are searched linearly, since there are only a few of them.
+ */
+static entry* get(entryArray* src, const char* name)
+{
+	size_t i;
+	
+	for (i = 0; i < src->count; ++i)
+		if (!strcmp(src->data[i].name, name))
+			return src->data + i;
+	
+	if (src->count == src->size)
+	{
+		src->size = (src->size) ? src->size << 1 : 16;
+		src->data = (entry*) realloc(src->data, sizeof(entry) * src->size);
+	}
+	
+	memset(src->data + src->count, 0, sizeof(entry));
+	src->data[src->count].name = name;
+	
+	return src->data + src->count++;
+}
+
+/**@brief Returns the peak resident set sizes in kilobytes.
+ */
+static void peak(unsigned long* self, unsigned long* children)
+{
+#ifndef _WIN32
+	struct rusage usage;
+	
+	getrusage(RUSAGE_SELF, &usage);
+	*self = (unsigned long) usage.ru_maxrss;
+	getrusage(RUSAGE_CHILDREN, &usage);
+	*children = (unsigned long) usage.ru_maxrss;
+#else
+	*self = *children = 0;
+#endif
+}
+
+/* ******************************************************* exported functions */
+
+stats* newStats()
+{
+	stats* res = (stats*) calloc(1, sizeof(stats));
+	
+	now(&res->start);
+#ifndef _WIN32
+	pthread_mutex_init(&res->lock, 0);
+#endif
+	return res;
+}
+
+void deleteStats(stats* src)
+{
+	if (!src)
+		return;
+	
+	if (src->trace)
+	{
+		fprintf(src->trace, "\n]\n");
+		fclose(src->trace);
+	}
+
+#ifndef _WIN32
+	pthread_mutex_destroy(&src->lock);
+#endif
+	
+	free(src->phases.data);
+	free(src->counters.data);
+	free(src);
+}
+
+void statsPhase(stats* src, const char* name)
+{
+	instant t;
+	
+	if (!src)
+		return;
+	
+	now(&t);
+	
+	if (src->phase)
+	{
+		src->phase->time.wall += t.wall - src->phaseStart.wall;
+		src->phase->time.cpu += t.cpu - src->phaseStart.cpu;
+		src->phase->time.children += t.children - src->phaseStart.children;
+		
+		if (src->trace)
+			statsSpan(src, "phase", src->phase->name, 0, src->phaseStart.wall);
+	}
+	
+	src->phase = (name) ? get(&src->phases, name) : 0;
+	src->phaseStart = t;
+}
+
+int statsTrace(stats* src, const char* path)
+{
+	if (!src)
+		return 0;
+	
+	if (src->trace)
+		fclose(src->trace);
+	
+	src->trace = fopen(path, "w");
+	src->events = 0;
+	
+	if (src->trace)
+		fprintf(src->trace, "[");
+	
+	return src->trace != 0;
+}
+
+double statsTime()
+{
+#ifndef _WIN32
+	struct timeval tv;
+	
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+void statsSpan(stats* src, const char* category, const char* name,
+               const char* detail, double begin)
+{
+	double end;
+	
+	if (!src || !src->trace)
+		return;
+	
+	end = statsTime();
+
+#ifndef _WIN32
+	pthread_mutex_lock(&src->lock);
+#endif
+	event(src, category, name, detail, begin, end);
+#ifndef _WIN32
+	pthread_mutex_unlock(&src->lock);
+#endif
+}
+
+void statsAdd(stats* src, const char* name, unsigned long value)
+{
+	if (src)
+		get(&src->counters, name)->value += value;
+}
+
+void statsDump(stats* src, FILE* out, int json)
+{
+	unsigned long self, children;
+	instant t;
+	size_t i;
+	
+	if (!src)
+		return;
+	
+	now(&t);
+	peak(&self, &children);
+	
+	if (json)
+	{
+		fprintf(out, "{\"wall\":%.6f,\"cpu\":%.6f,\"children\":%.6f,"
+		        "\"peakRss\":%lu,\"peakChildRss\":%lu,\"phases\":[",
+		        t.wall - src->start.wall, t.cpu - src->start.cpu,
+		        t.children - src->start.children, self, children);
+		
+		for (i = 0; i < src->phases.count; ++i)
+		{
+			const entry* e = src->phases.data + i;
+			
+			fprintf(out, "%s\n{\"name\":\"%s\",\"wall\":%.6f,\"cpu\":%.6f,"
+			        "\"children\":%.6f}", (i) ? "," : "", e->name, e->time.wall,
+			        e->time.cpu, e->time.children);
+		}
+		
+		fprintf(out, "\n],\"counters\":{");
+		
+		for (i = 0; i < src->counters.count; ++i)
+			fprintf(out, "%s\n\"%s\":%lu", (i) ? "," : "",
+			        src->counters.data[i].name, src->counters.data[i].value);
+		
+		fprintf(out, "\n}}\n");
+		return;
+	}
+	
+	fprintf(out, "\n<STATS wall=\"%.3f\" cpu=\"%.3f\" children=\"%.3f\" "
+	        "peakRss=\"%lu\" peakChildRss=\"%lu\">\n",
+	        t.wall - src->start.wall, t.cpu - src->start.cpu,
+	        t.children - src->start.children, self, children);
+	
+	for (i = 0; i < src->phases.count; ++i)
+	{
+		const entry* e = src->phases.data + i;
+		
+		fprintf(out, "\t<PHASE name=\"%s\" wall=\"%.3f\" cpu=\"%.3f\" "
+		        "children=\"%.3f\"/>\n", e->name, e->time.wall, e->time.cpu,
+		        e->time.children);
+	}
+	
+	for (i = 0; i < src->counters.count; ++i)
+		fprintf(out, "\t<COUNT name=\"%s\">%lu</COUNT>\n",
+		        src->counters.data[i].name, src->counters.data[i].value);
+	
+	fprintf(out, "</STATS>\n");
+}
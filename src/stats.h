@@ -0,0 +1,93 @@
+/***************************************************************************//**
+ * @file stats.h
+ * @author Dorian Weber
+ * @brief Interface of the run statistics.
+ *
+ * A run is divided into named phases, one following the other. Every phase
+ * accumulates the elapsed wall time, the CPU time of the process and the CPU
+ * time of the subprocesses that were waited for. Phases that are entered
+ * repeatedly sum up. Besides that, named counters can be added up.
+ *
+ * Optionally, the phases and additional spans, e.g. of subprocesses or worker
+ * threads, are written as complete events in the Chrome trace event format,
+ * which Perfetto and chrome://tracing display as a timeline per thread.
+ *
+ * All functions ignore a \c NULL pointer instead of statistics, so callers
+ * don't need to check whether they are collected.
+ *
+ * @sa stats.c
+ ******************************************************************************/
+
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* forward declaration of opaque structure */
+typedef struct s_stats stats;
+
+/**@brief Creates the statistics of a run, which starts right away.
+ */
+extern stats* newStats();
+
+/**@brief Frees the statistics.
+ */
+extern void deleteStats(stats* src);
+
+/**@brief Ends the current phase and starts another one.
+ * @param[in] src   the statistics
+ * @param[in] name  name of the phase, must outlive the statistics, \c NULL to
+ *                  just end the current phase
+ */
+extern void statsPhase(stats* src, const char* name);
+
+/**@brief Adds a value to a counter, which gets created at zero.
+ * @param[in] src    the statistics
+ * @param[in] name   name of the counter, must outlive the statistics
+ * @param[in] value  the value
+ */
+extern void statsAdd(stats* src, const char* name, unsigned long value);
+
+/**@brief Starts writing trace events into a file, which gets closed
+ * together with the statistics.
+ * @return \c 1 on success, \c 0 if the file can't be written
+ */
+extern int statsTrace(stats* src, const char* path);
+
+/**@brief Returns the current wall time in seconds, as the beginning of a
+ * span.
+ */
+extern double statsTime();
+
+/**@brief Writes a trace event of a span that ends now, attributed to the
+ * calling thread.
+ * @note This function may be called from several threads at once.
+ *
+ * @param[in] src       the statistics
+ * @param[in] category  category of the span, e.g. \c "subprocess"
+ * @param[in] name      name of the span
+ * @param[in] detail    additional text shown with the span, may be \c NULL
+ * @param[in] begin     beginning of the span, taken from statsTime()
+ */
+extern void statsSpan(stats* src, const char* category, const char* name,
+                      const char* detail, double begin);
+
+/**@brief Dumps the phases, the totals, the peak memory usage and the
+ * counters, either in XML-like or in JSON format.
+ * @note Times are given in seconds, memory in kilobytes.
+ *
+ * @param[in] src   the statistics
+ * @param[in] out   destination
+ * @param[in] json  \c 1 for JSON, \c 0 for XML-like format
+ */
+extern void statsDump(stats* src, FILE* out, int json);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,189 @@
+/***************************************************************************//**
+ * @file watch.c
+ * @author Dorian Weber
+ * @brief Implementation of the watch mode.
+ ******************************************************************************/
+
+#include "watch.h"
+#include "deadstrip.h"
+#include "driver.h"
+#include "hashmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+/* *************************************************************** structures */
+
+#define SO_QUIET   200   /**<@brief Milliseconds without events that end a burst. */
+#define SO_EVENTS  (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE)
+
+#ifdef __linux__
+
+/* ******************************************************** private functions */
+
+/**@brief Watches the directory of an object and registers the object under
+ * the watch descriptor and its base name.
+ * @param[in] fd     inotify instance
+ * @param[in] names  set of "descriptor/base name" keys
+ * @param[in] obj    object file
+ * @return \c 0 on success, \c -1 if the directory can't be watched
+ */
+static int watchObject(int fd, hashmap* names, objectFile* obj)
+{
+	const char* name = objectFileGetName(obj);
+	const char* base = strrchr(name, '/');
+	char* key;
+	int wd;
+	
+	/* watch the directory, since compilers tend to replace files */
+	if (base)
+	{
+		char* dir = (base == name) ? strdup("/") : strndup(name, base - name);
+		
+		wd = inotify_add_watch(fd, dir, SO_EVENTS);
+		free(dir);
+		++base;
+	}
+	else
+	{
+		wd = inotify_add_watch(fd, ".", SO_EVENTS);
+		base = name;
+	}
+	
+	if (wd < 0)
+	{
+		fprintf(stderr, "ERROR: can't watch the directory of %s.\n", name);
+		return -1;
+	}
+	
+	key = (char*) malloc(strlen(base) + 24);
+	sprintf(key, "%d/%s", wd, base);
+	hashmapSet(names, (void*) 1, key);
+	free(key);
+	
+	return 0;
+}
+
+/**@brief Reads the pending events and reports, whether one of them concerns
+ * a watched object.
+ * @param[in] fd     inotify instance
+ * @param[in] names  set of "descriptor/base name" keys
+ * @return \c 1, if a watched object was touched, \c 0 if not, \c -1 on failure
+ */
+static int readEvents(int fd, hashmap* names)
+{
+	/* the events get read in place, so the buffer has to be aligned for them */
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	char key[4096 + 24];
+	const struct inotify_event* ev;
+	ssize_t len;
+	int res = 0;
+	
+	len = read(fd, buffer, sizeof(buffer));
+	
+	if (len < 0)
+		return (errno == EINTR) ? 0 : -1;
+	
+	for (ev = (const struct inotify_event*) buffer;
+	     (const char*) ev < buffer + len;
+	     ev = (const struct inotify_event*) ((const char*) ev + sizeof(*ev) + ev->len))
+	{
+		if (!ev->len)
+			continue;
+		
+		sprintf(key, "%d/%s", ev->wd, ev->name);
+		if (hashmapGet(names, key))
+			res = 1;
+	}
+	
+	return res;
+}
+
+/* ******************************************************* exported functions */
+
+int watchRun(int argc, const char* argv[])
+{
+	deadstrip* ds = newDeadstrip();
+	hashmap* names = newHashmap(8);
+	list* objects;
+	int fd = inotify_init(), watched = 1;
+	
+	if (fd < 0)
+	{
+		fprintf(stderr, "ERROR: can't initialize inotify.\n");
+		deleteHashmap(names);
+		deleteDeadstrip(ds);
+		return -1;
+	}
+	
+	driverRun(ds, argc, argv, stdout, stderr);
+	fflush(stdout);
+	
+	objects = deadstripGetObjects(ds);
+	listStart(objects);
+	while (watched && listNext(objects))
+		watched = !watchObject(fd, names, (objectFile*) listGet(objects));
+	
+	if (listIsEmpty(objects))
+		fprintf(stderr, "ERROR: there are no objects to watch.\n");
+	
+	else if (watched) for (;;)
+	{
+		struct pollfd pfd;
+		int changed = readEvents(fd, names), stale = 0;
+		
+		if (changed < 0)
+		{
+			fprintf(stderr, "ERROR: can't read the changes of the objects.\n");
+			break;
+		}
+		if (!changed)
+			continue;
+		
+		/* wait for the burst to calm down */
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		
+		while (poll(&pfd, 1, SO_QUIET) > 0)
+			if (readEvents(fd, names) < 0)
+				break;
+		
+		/* the remover writes the objects as well, but records their state */
+		objects = deadstripGetObjects(ds);
+		listStart(objects);
+		while (listNext(objects))
+			stale += objectFileRefresh((objectFile*) listGet(objects));
+		
+		if (stale)
+		{
+			printf("\n*** %d object%s changed\n", stale, (stale == 1) ? "" : "s");
+			driverRun(ds, argc, argv, stdout, stderr);
+			fflush(stdout);
+		}
+	}
+	
+	close(fd);
+	deleteHashmap(names);
+	deleteDeadstrip(ds);
+	
+	return -1;
+}
+
+#else
+
+int watchRun(int argc, const char* argv[])
+{
+	(void) argc, (void) argv;
+	fprintf(stderr, "ERROR: the watch mode isn't supported on this platform.\n");
+	return -1;
+}
+
+#endif
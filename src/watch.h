@@ -0,0 +1,28 @@
+/***************************************************************************//**
+ * @file watch.h
+ * @author Dorian Weber
+ * @brief Interface of the watch mode, which relinks whenever objects change.
+ * 
+ * The command line is processed once and the directories of its objects are
+ * monitored afterwards. Bursts of changes, e.g. from a parallel build, are
+ * coalesced into a single run, which only dumps the objects that changed.
+ * Changes made by the remover itself don't trigger another run.
+ * 
+ * @sa watch.c
+ ******************************************************************************/
+
+#ifndef WATCH_H_INCLUDED
+#define WATCH_H_INCLUDED
+
+/**@brief Runs a command line and repeats it every time an object changes.
+ * @note The function only returns on failure, failed runs don't end it.
+ * 
+ * @param[in] argc  number of arguments
+ * @param[in] argv  command line, including the program name
+ * @return always \c -1, once the objects can't be monitored: inotify isn't
+ *         available, the command line names no objects, a directory can't be
+ *         watched or reading the changes fails
+ */
+extern int watchRun(int argc, const char* argv[]);
+
+#endif
@@ -0,0 +1,312 @@
+/***************************************************************************//**
+ * @file containers.c
+ * @author Dorian Weber
+ * @brief Test of the containers the analysis is built on.
+ *
+ * Every test applies random operations to a container and to a plain array
+ * that models it, and compares both after every operation.
+ ******************************************************************************/
+
+#include "graph.h"
+#include "hashmap.h"
+#include "list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* *************************************************************** structures */
+
+#define SO_ROUNDS    2000  /**<@brief Number of operations per test. */
+#define SO_ITEMS     256   /**<@brief Maximal number of modeled items. */
+#define SO_KEYS      600   /**<@brief Number of possible hashmap keys. */
+#define SO_NODES     64    /**<@brief Number of graph nodes. */
+
+static unsigned long checks; /**<@brief Number of passed checks. */
+static int failed; /**<@brief Set, once a check failed. */
+
+static char keys[SO_KEYS][24]; /**<@brief Keys of the hashmap. */
+static const char* lastKey; /**<@brief Last key visited by hashmapProcess(). */
+static int visited; /**<@brief Number of entries visited by hashmapProcess(). */
+static int misplaced; /**<@brief Number of entries visited out of order. */
+
+/* ******************************************************** private functions */
+
+/**@brief Returns a pseudo-random number below a limit.
+ */
+static int pick(int limit)
+{
+	return (int) ((unsigned int) rand() % (unsigned int) limit);
+}
+
+/**@brief Counts a check and reports it, if it failed.
+ * @return the condition
+ */
+static int check(int cond, const char* test, int round, const char* what)
+{
+	if (cond)
+		++checks;
+	else if (!failed)
+	{
+		printf("%s, round %d: %s\n", test, round, what);
+		failed = 1;
+	}
+	
+	return cond;
+}
+
+/**@brief Compares a list with the modeled items.
+ */
+static void compareList(list* src, const long* items, int count, int round)
+{
+	int i = 0;
+	
+	check(listCount(src) == count, "list", round, "wrong count");
+	
+	listStart(src);
+	while (listNext(src) && i < count)
+		if (!check((long) listGet(src) == items[i++], "list", round, "wrong item"))
+			return;
+}
+
+/**@brief Tests positions from listTell(), which get appended to and removed
+ * through listSeek(), the way graphConnect() keeps the tails of its lists.
+ */
+static void testList()
+{
+	list* src = newList();
+	void* pos[SO_ITEMS + 1];
+	long items[SO_ITEMS];
+	int count = 0, round, i;
+	
+	/* the position of the top element inserts in front */
+	pos[0] = listTell(src);
+	
+	for (round = 0; round < SO_ROUNDS && !failed; ++round)
+	{
+		switch (pick(4))
+		{
+		case 0: /* insert behind a remembered position */
+		case 1:
+			if (count == SO_ITEMS)
+				break;
+			
+			i = pick(count + 1);
+			memmove(items + i + 1, items + i, sizeof(long) * (count - i));
+			items[i] = round;
+			
+			listSeek(src, pos[i]);
+			listAdd(src, (void*) (long) round);
+			
+			/* the new element is selected, the others keep their positions */
+			memmove(pos + i + 2, pos + i + 1, sizeof(void*) * (count - i));
+			pos[i + 1] = listTell(src);
+			++count;
+			break;
+		
+		case 2: /* remove at a remembered position */
+			if (!count)
+				break;
+			
+			i = pick(count);
+			memmove(items + i, items + i + 1, sizeof(long) * (count - i - 1));
+			
+			listSeek(src, pos[i + 1]);
+			listRemove(src);
+			
+			/* the predecessor is selected */
+			check(listTell(src) == pos[i], "list", round, "wrong selection");
+			memmove(pos + i + 1, pos + i + 2, sizeof(void*) * (count - i - 1));
+			--count;
+			break;
+		
+		default: /* remove while walking */
+			listStart(src);
+			for (i = 0; listNext(src); )
+				if ((long) listGet(src) % 3 == round % 3)
+					listRemove(src);
+				else
+				{
+					items[i] = (long) listGet(src);
+					pos[++i] = listTell(src);
+				}
+			count = i;
+		}
+		
+		/* the remembered positions of the remaining elements are still valid */
+		listStart(src);
+		check(listTell(src) == pos[0], "list", round, "wrong position");
+		for (i = 1; listNext(src); ++i)
+			if (!check(i <= count && listTell(src) == pos[i], "list", round,
+			           "wrong position"))
+				break;
+		
+		compareList(src, items, count, round);
+	}
+	
+	deleteList(src);
+}
+
+/**@brief Checks that hashmapProcess() visits the keys in order.
+ */
+static void visit(const char* key, const void* datum)
+{
+	(void) datum;
+	
+	if (lastKey && strcmp(lastKey, key) >= 0)
+		++misplaced;
+	
+	lastKey = key;
+	++visited;
+}
+
+/**@brief Tests a hashmap under churn, which leaves many removed entries
+ * behind, so rehashing has to drop them without growing forever.
+ */
+static void testHashmap()
+{
+	hashmap* map = newHashmap(4);
+	long data[SO_KEYS];
+	int count = 0, round, i;
+	
+	memset(data, 0, sizeof(data));
+	
+	for (i = 0; i < SO_KEYS; ++i)
+		sprintf(keys[i], (i & 1) ? "_Z%dlongerKey" : "k%d", i);
+	
+	for (round = 0; round < 50 * SO_ROUNDS && !failed; ++round)
+	{
+		/* the live keys stay in a sliding window, the others get removed */
+		i = (round / 8 + pick(SO_ITEMS)) % SO_KEYS;
+		
+		if (pick(2))
+		{
+			int res = hashmapSet(map, (void*) (long) (round + 1), keys[i]);
+			
+			check(res == ((data[i]) ? HASHMAP_UPDATE : HASHMAP_INSERT), "hashmap",
+			      round, "wrong result of hashmapSet");
+			count += !data[i];
+			data[i] = round + 1;
+		}
+		else
+		{
+			check((long) hashmapRemove(map, keys[i]) == data[i], "hashmap", round,
+			      "wrong result of hashmapRemove");
+			count -= !!data[i];
+			data[i] = 0;
+		}
+		
+		if (round % 997)
+			continue;
+		
+		for (i = 0; i < SO_KEYS; ++i)
+			if (!check((long) hashmapGet(map, keys[i]) == data[i], "hashmap", round,
+			           "wrong result of hashmapGet"))
+				break;
+		
+		lastKey = 0;
+		visited = misplaced = 0;
+		hashmapProcess(map, visit);
+		check(visited == count, "hashmap", round, "wrong number of processed entries");
+		check(!misplaced, "hashmap", round, "entries processed out of order");
+	}
+	
+	deleteHashmap(map);
+}
+
+/**@brief Compares the edges of a node with the modeled ones, which are kept
+ * in the order they were added in.
+ */
+static void compareEdges(graph* src, const int* order, int count,
+                         graph** nodes, unsigned long (*weights)[SO_NODES],
+                         int from, int round)
+{
+	list *con = graphGetConnections(src), *weight = graphGetWeights(src);
+	int i = 0;
+	
+	check(listCount(con) == count && listCount(weight) == count, "graph", round,
+	      "wrong number of edges");
+	
+	listStart(con);
+	listStart(weight);
+	while (listNext(con) && listNext(weight) && i < count)
+	{
+		int to = order[i++];
+		
+		if (!check(listGet(con) == nodes[to], "graph", round, "wrong edge")
+		    || !check((unsigned long) listGet(weight) == weights[from][to], "graph",
+		              round, "wrong weight"))
+			return;
+	}
+}
+
+/**@brief Tests the edges of a graph, in particular the ones of a hub whose
+ * edges get indexed once there are many of them.
+ */
+static void testGraph()
+{
+	static unsigned long weights[SO_NODES][SO_NODES];
+	static int order[SO_NODES][SO_NODES], degree[SO_NODES];
+	graph* nodes[SO_NODES];
+	int round, i, j;
+	
+	for (i = 0; i < SO_NODES; ++i)
+		nodes[i] = newGraph("node");
+	
+	for (round = 0; round < 20 * SO_ROUNDS && !failed; ++round)
+	{
+		int from = (pick(2)) ? 0 : pick(SO_NODES), to = pick(SO_NODES);
+		
+		/* connect more often than not, so the hub fills up and drains again */
+		if (pick(8) < ((round / 2000) % 2 ? 3 : 5))
+		{
+			if (!weights[from][to])
+				order[from][degree[from]++] = to;
+			
+			check(graphConnect(nodes[from], nodes[to]) == ++weights[from][to],
+			      "graph", round, "wrong result of graphConnect");
+		}
+		else if (weights[from][to])
+		{
+			check(graphDisconnect(nodes[from], nodes[to]) == --weights[from][to],
+			      "graph", round, "wrong result of graphDisconnect");
+			
+			if (!weights[from][to])
+			{
+				for (i = 0; order[from][i] != to; ++i);
+				memmove(order[from] + i, order[from] + i + 1,
+				        sizeof(int) * (--degree[from] - i));
+			}
+		}
+		
+		compareEdges(nodes[from], order[from], degree[from], nodes, weights, from,
+		             round);
+		
+		/* the predecessors hold every source of an edge once */
+		for (i = j = 0; i < SO_NODES; ++i)
+			j += weights[i][to] != 0;
+		
+		check(listCount(graphGetPredecessors(nodes[to])) == j, "graph", round,
+		      "wrong number of predecessors");
+	}
+	
+	for (i = 0; i < SO_NODES; ++i)
+		deleteGraph(nodes[i]);
+}
+
+/* ******************************************************* exported functions */
+
+int main()
+{
+	srand(1);
+	
+	testList();
+	testHashmap();
+	testGraph();
+	
+	if (failed)
+		return 1;
+	
+	printf("containers: ok, %lu checks\n", checks);
+	return 0;
+}
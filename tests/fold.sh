@@ -0,0 +1,35 @@
+#!/bin/sh
+# Checks that --fold only folds functions whose references are the same.
+#
+# usage: tests/fold.sh
+#
+# The objects in tests/fold are replayed by the stand-ins in bench/bin. Both
+# objects define five pairs of functions with identical contents:
+#   fa, fb  reference their own .rdata, which differs
+#   ha, hb  reference their own static .bss$x
+#   ka, kb  reference puts at different offsets
+#   ma, mb  reference puts with different relocation types
+#   ga, gb  only call puts, so they are the only ones to fold
+
+TESTS=$(cd "$(dirname "$0")" && pwd)
+DEADSTRIP=$TESTS/../deadstrip
+TOOLS="--dumper $TESTS/../bench/bin/objdump --remover $TESTS/../bench/bin/objcopy --linker $TESTS/../bench/bin/ld"
+LOG=${TMPDIR:-/tmp}/deadstrip-fold.$$
+
+trap 'rm -f "$LOG"' EXIT
+
+(cd "$TESTS/fold" && STANDIN_LOG=$LOG "$DEADSTRIP" $TOOLS --fold \
+	-o app.exe a.o b.o) > /dev/null || { echo "ERROR: deadstrip failed"; exit 1; }
+
+linked=$(grep '^ld ' "$LOG")
+expected="ld -o app.exe a.o b.o --defsym _gb=_ga"
+
+if [ "$linked" != "$expected" ]; then
+	echo "ERROR: fold linked"
+	echo "  $linked"
+	echo "instead of"
+	echo "  $expected"
+	exit 1
+fi
+
+echo "fold: ok"
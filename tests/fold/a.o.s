@@ -0,0 +1,14 @@
+Contents of section .text$main:
+ 0000 5589e5e8 00000000 e8000000 00c9c300  U...............
+Contents of section .text$fa:
+ 0000 68000000 00e80000                    h.......
+Contents of section .rdata:
+ 0000 61000000                             a...
+Contents of section .text$ga:
+ 0000 e8000000 00c3c3c3                    ........
+Contents of section .text$ha:
+ 0000 a1000000 00c3c3c3                    ........
+Contents of section .text$ka:
+ 0000 e8e80000 0000c3c3                    ........
+Contents of section .text$ma:
+ 0000 e9000000 00c3c3c3                    ........
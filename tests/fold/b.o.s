@@ -0,0 +1,12 @@
+Contents of section .text$fb:
+ 0000 68000000 00e80000                    h.......
+Contents of section .rdata:
+ 0000 62000000                             b...
+Contents of section .text$gb:
+ 0000 e8000000 00c3c3c3                    ........
+Contents of section .text$hb:
+ 0000 a1000000 00c3c3c3                    ........
+Contents of section .text$kb:
+ 0000 e8e80000 0000c3c3                    ........
+Contents of section .text$mb:
+ 0000 e9000000 00c3c3c3                    ........
@@ -0,0 +1,341 @@
+/***************************************************************************//**
+ * @file incremental.c
+ * @author Dorian Weber
+ * @brief Test of the incrementally maintained reachability.
+ *
+ * Applies random changes to an analysis: objects get added, rewritten and
+ * dropped, seeds get replaced through deadstripSyncSeeds(), references get
+ * added and removed by hand, and a second color gets planted and removed.
+ * After every change, the maintained colors have to match the ones
+ * deadstripVerify() recomputes, and the ones of an analysis that gets built
+ * from scratch out of the same objects, references and seeds.
+ *
+ * The objects are files in a temporary directory that contain their own
+ * objdump output, so they're replayed without a toolchain. Rewritten objects
+ * get a new modification time, so only they count as stale.
+ ******************************************************************************/
+
+#include "deadstrip.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <utime.h>
+
+/* *************************************************************** structures */
+
+#define SO_OBJECTS   16   /**<@brief Number of possible objects. */
+#define SO_KEYS      48   /**<@brief Number of possible section keys. */
+#define SO_EDGES     64   /**<@brief Maximal number of references by hand. */
+#define SO_ROUNDS    400  /**<@brief Number of changes. */
+#define SO_COLOR     0x2UL  /**<@brief Color planted besides the seeds. */
+
+/**@brief A reference added by hand.
+ */
+typedef struct
+{
+	int src; /**< Referencing key, \c -1 for an unknown section. */
+	int dest; /**< Referenced key. */
+} edge;
+
+/**@brief State the analysis has to reflect.
+ */
+typedef struct
+{
+	char dir[64]; /**< Directory of the objects. */
+	char names[SO_OBJECTS][96]; /**< Paths of the objects. */
+	int present[SO_OBJECTS]; /**< Set, if an object takes part. */
+	unsigned int versions[SO_OBJECTS]; /**< Contents of the objects. */
+	int seeds[SO_KEYS]; /**< Set, if a key is a seed. */
+	int planted[SO_KEYS]; /**< Set, if a key carries the second color. */
+	edge edges[SO_EDGES]; /**< References added by hand. */
+	int edgeCount; /**< Number of references added by hand. */
+	long clock; /**< Modification time of the next written object. */
+} model;
+
+static char keys[SO_KEYS][16]; /**<@brief Keys of the sections. */
+
+/* ******************************************************** private functions */
+
+/**@brief Returns a pseudo-random number below a limit.
+ */
+static int pick(int limit)
+{
+	return (int) ((unsigned int) rand() % (unsigned int) limit);
+}
+
+/**@brief Writes what objdump -rh prints for a version of an object.
+ */
+static void dump(const model* m, int obj, FILE* out)
+{
+	unsigned int seed = m->versions[obj] * 7919u + (unsigned int) obj;
+	int decl[6], count = 1 + (int) (seed % 6), i, j;
+	
+	fprintf(out, "\n%s:     file format pe-i386\n\n"
+	        "Sections:\n"
+	        "Idx Name          Size      VMA       LMA       File off  Algn\n",
+	        m->names[obj]);
+	
+	for (i = 0; i < count; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		decl[i] = (int) ((seed >> 8) % SO_KEYS);
+		fprintf(out, "%3d .text$%-8s %08x  00000000  00000000  00000000  2**4\n"
+		        "                  CONTENTS, ALLOC, LOAD, RELOC, READONLY, CODE\n",
+		        i, keys[decl[i]], 16 + i);
+	}
+	
+	for (i = 0; i < count; ++i)
+	{
+		int refs;
+		
+		seed = seed * 1103515245u + 12345u;
+		refs = (int) ((seed >> 8) % 4);
+		
+		if (!refs)
+			continue;
+		
+		fprintf(out, "RELOCATION RECORDS FOR [.text$%s]:\n"
+		        "OFFSET   TYPE              VALUE\n", keys[decl[i]]);
+		
+		for (j = 0; j < refs; ++j)
+		{
+			seed = seed * 1103515245u + 12345u;
+			
+			if ((seed >> 8) % 8)
+				fprintf(out, "%08x DISP32            _%s\n", j,
+				        keys[(seed >> 12) % SO_KEYS]);
+			else
+				fprintf(out, "%08x DISP32            _ext%u\n", j,
+				        (seed >> 12) % 4);
+		}
+		
+		fprintf(out, "\n");
+	}
+}
+
+/**@brief Writes an object with a new modification time.
+ * @return \c 0 on failure
+ */
+static int writeObject(model* m, int obj)
+{
+	FILE* out = fopen(m->names[obj], "w");
+	struct utimbuf times;
+	
+	if (!out)
+		return 0;
+	
+	dump(m, obj, out);
+	
+	if (fclose(out))
+		return 0;
+	
+	times.actime = times.modtime = ++m->clock;
+	return !utime(m->names[obj], &times);
+}
+
+/**@brief Brings the objects of an analysis up to date, like the driver does.
+ */
+static void syncObjects(const model* m, deadstrip* ds)
+{
+	list* names = newList();
+	FILE* dumps = tmpfile();
+	int i;
+	
+	for (i = 0; i < SO_OBJECTS; ++i)
+		if (m->present[i])
+		{
+			listAdd(names, m->names[i]);
+			dump(m, i, dumps);
+		}
+	
+	/* the dumps of unchanged objects are skipped */
+	if (deadstripSyncObjects(ds, names))
+	{
+		rewind(dumps);
+		deadstripCollect(ds, dumps);
+	}
+	
+	fclose(dumps);
+	deleteList(names);
+}
+
+/**@brief Replaces the seeds of an analysis.
+ */
+static void syncSeeds(const model* m, deadstrip* ds)
+{
+	list* seeds = newList();
+	int i;
+	
+	for (i = 0; i < SO_KEYS; ++i)
+		if (m->seeds[i])
+			listAdd(seeds, keys[i]);
+	
+	deadstripSyncSeeds(ds, seeds, DEADSTRIP_SEED);
+	deleteList(seeds);
+}
+
+/**@brief Builds an analysis from scratch.
+ */
+static deadstrip* rebuild(const model* m)
+{
+	deadstrip* res = newDeadstrip();
+	int i;
+	
+	syncObjects(m, res);
+	
+	for (i = 0; i < m->edgeCount; ++i)
+		deadstripConnect(res, (m->edges[i].src < 0) ? 0 : keys[m->edges[i].src],
+		                 keys[m->edges[i].dest]);
+	
+	syncSeeds(m, res);
+	
+	for (i = 0; i < SO_KEYS; ++i)
+		if (m->planted[i])
+			deadstripColorize(res, keys[i], SO_COLOR);
+	
+	return res;
+}
+
+/**@brief Applies a random change to the model and the analysis.
+ * @return description of the change
+ */
+static const char* change(model* m, deadstrip* ds)
+{
+	int i = pick(SO_KEYS);
+	
+	switch (pick(7))
+	{
+	case 0: /* add or drop an object */
+		i = pick(SO_OBJECTS);
+		
+		if ((m->present[i] = !m->present[i]))
+		{
+			++m->versions[i];
+			writeObject(m, i);
+		}
+		
+		syncObjects(m, ds);
+		return "toggle object";
+	
+	case 1: /* rewrite an object */
+		i = pick(SO_OBJECTS);
+		
+		if (!m->present[i])
+			return "nothing";
+		
+		++m->versions[i];
+		writeObject(m, i);
+		syncObjects(m, ds);
+		return "rewrite object";
+	
+	case 2: /* replace some seeds */
+		m->seeds[i] = !m->seeds[i];
+		m->seeds[pick(SO_KEYS)] = pick(2);
+		syncSeeds(m, ds);
+		return "sync seeds";
+	
+	case 3: /* plant or remove the second color */
+		if ((m->planted[i] = !m->planted[i]))
+			deadstripColorize(ds, keys[i], SO_COLOR);
+		else
+			deadstripUncolorize(ds, keys[i], SO_COLOR);
+		return "plant color";
+	
+	case 4: /* add a reference */
+		if (m->edgeCount == SO_EDGES)
+			return "nothing";
+		
+		m->edges[m->edgeCount].src = (pick(8)) ? pick(SO_KEYS) : -1;
+		m->edges[m->edgeCount].dest = i;
+		deadstripConnect(ds, (m->edges[m->edgeCount].src < 0)
+		                 ? 0 : keys[m->edges[m->edgeCount].src], keys[i]);
+		++m->edgeCount;
+		return "connect";
+	
+	default: /* remove a reference */
+		if (!m->edgeCount)
+			return "nothing";
+		
+		i = pick(m->edgeCount);
+		deadstripDisconnect(ds, (m->edges[i].src < 0) ? 0 : keys[m->edges[i].src],
+		                    keys[m->edges[i].dest]);
+		m->edges[i] = m->edges[--m->edgeCount];
+		return "disconnect";
+	}
+}
+
+/* ******************************************************* exported functions */
+
+int main()
+{
+	model m;
+	deadstrip* ds = newDeadstrip();
+	unsigned long colored = 0;
+	int round, i, failed = 0;
+	
+	memset(&m, 0, sizeof(model));
+	strcpy(m.dir, "/tmp/deadstrip-incremental.XXXXXX");
+	m.clock = 1000000000L;
+	srand(1);
+	
+	if (!mkdtemp(m.dir))
+	{
+		fprintf(stderr, "ERROR: can't create a temporary directory\n");
+		return 2;
+	}
+	
+	for (i = 0; i < SO_KEYS; ++i)
+		sprintf(keys[i], "f%d", i);
+	
+	for (i = 0; i < SO_OBJECTS; ++i)
+		sprintf(m.names[i], "%s/o%d.o", m.dir, i);
+	
+	for (round = 0; round < SO_ROUNDS && !failed; ++round)
+	{
+		const char* what = change(&m, ds);
+		deadstrip* fresh = rebuild(&m);
+		unsigned long wrong = 0;
+		
+		for (i = 0; i < SO_KEYS; ++i)
+		{
+			unsigned long color = deadstripGetColor(ds, keys[i]);
+			
+			if (color != deadstripGetColor(fresh, keys[i]))
+			{
+				printf("round %d (%s): %s has color %lu instead of %lu\n",
+				       round, what, keys[i], color,
+				       deadstripGetColor(fresh, keys[i]));
+				++wrong;
+			}
+			
+			colored += color != 0;
+		}
+		
+		/* deadstripVerify() replaces the colors, so it comes last */
+		if ((i = (int) deadstripVerify(ds)))
+		{
+			printf("round %d (%s): %d sections differ from the recomputed "
+			       "colors\n", round, what, i);
+			++wrong;
+		}
+		
+		failed = wrong != 0;
+		deleteDeadstrip(fresh);
+	}
+	
+	deleteDeadstrip(ds);
+	
+	for (i = 0; i < SO_OBJECTS; ++i)
+		unlink(m.names[i]);
+	
+	rmdir(m.dir);
+	
+	if (failed)
+		return 1;
+	
+	printf("incremental: ok, %d changes, %lu colored sections checked\n",
+	       round, colored);
+	return 0;
+}
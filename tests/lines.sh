@@ -0,0 +1,62 @@
+#!/bin/sh
+# Checks that dumps and profiles are read with lines of any length.
+#
+# usage: tests/lines.sh
+#
+# Mangled names can get much longer than any fixed line buffer. The dump
+# written here for the stand-ins in bench/bin declares a function with a name
+# of 2000 characters that main calls, and an unused one. The long function
+# has to stay in the link, and a profile that names it has to move it in front
+# of main in the ordering file.
+
+TESTS=$(cd "$(dirname "$0")" && pwd)
+DEADSTRIP=$TESTS/../deadstrip
+TOOLS="--dumper $TESTS/../bench/bin/objdump --remover $TESTS/../bench/bin/objcopy --linker $TESTS/../bench/bin/ld"
+OUT=${TMPDIR:-/tmp}/deadstrip-lines.$$
+
+trap 'rm -rf "$OUT"' EXIT
+mkdir -p "$OUT" || exit 1
+
+name=Z$(printf '%02000d' 0 | tr 0 x)
+
+cat > "$OUT/a.o" <<EOF
+Sections:
+Idx Name          Size      VMA       LMA       File off  Algn
+  0 .text\$main    00000010  00000000  00000000  00000000  2**4
+                  CONTENTS, ALLOC, LOAD, RELOC, READONLY, CODE
+  1 .text\$$name    00000008  00000000  00000000  00000000  2**4
+                  CONTENTS, ALLOC, LOAD, READONLY, CODE
+  2 .text\$dead    00000008  00000000  00000000  00000000  2**4
+                  CONTENTS, ALLOC, LOAD, READONLY, CODE
+RELOCATION RECORDS FOR [.text\$main]:
+OFFSET   TYPE              VALUE
+00000004 DISP32            _$name
+
+EOF
+
+printf 'main 1\n%s 100\n' "$name" > "$OUT/profile"
+
+(cd "$OUT" && STANDIN_LOG=$OUT/log "$DEADSTRIP" $TOOLS --profile profile \
+	--order order -o app.exe a.o) > /dev/null || { echo "ERROR: deadstrip failed"; exit 1; }
+
+removed=$(grep '^objcopy ' "$OUT/log")
+
+case $removed in
+*"$name"*)
+	echo "ERROR: the function of the long name was removed"
+	exit 1;;
+*'.text$dead'*)
+	;;
+*)
+	echo "ERROR: the unused function wasn't removed"
+	exit 1;;
+esac
+
+first=$(sed -n 3p "$OUT/order")
+
+if [ "$first" != "	*(.text\$$name)" ]; then
+	echo "ERROR: the profiled function isn't ordered first"
+	exit 1
+fi
+
+echo "lines: ok"
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Checks that replaying a dependency map reports the same as the analysis
+# that wrote it.
+#
+# usage: tests/map.sh
+#
+# The objects in tests/map are replayed by the stand-ins in bench/bin. They
+# declare sections of several alignments, unwind information associated with
+# its functions and a section that both of them declare. The retained sizes
+# (--dret) and the savings (--dsav) of --from-map have to equal the ones of
+# the live analysis for both map formats, and the binary map written from a
+# replayed one has to equal the original.
+
+TESTS=$(cd "$(dirname "$0")" && pwd)
+DEADSTRIP=$TESTS/../deadstrip
+TOOLS="--dumper $TESTS/../bench/bin/objdump --remover $TESTS/../bench/bin/objcopy --linker $TESTS/../bench/bin/ld"
+OUT=${TMPDIR:-/tmp}/deadstrip-map.$$
+
+trap 'rm -rf "$OUT"' EXIT
+mkdir -p "$OUT" || exit 1
+
+cd "$TESTS/map" || exit 1
+
+"$DEADSTRIP" $TOOLS --dnrm --dmap --bmap "$OUT/map.bin" --dret --dsav \
+	-o app.exe a.o b.o > "$OUT/live" || { echo "ERROR: deadstrip failed"; exit 1; }
+
+# the XML map is part of the output, the reports follow it
+sed -n '/<MAP>/,/<\/MAP>/p' "$OUT/live" > "$OUT/map.xml"
+sed -n '/<RETAINED>/,$p' "$OUT/live" > "$OUT/expected"
+
+for map in map.bin map.xml; do
+	"$DEADSTRIP" --from-map "$OUT/$map" --dret --dsav -o app.exe \
+		| sed -n '/<RETAINED>/,$p' > "$OUT/replayed"
+
+	if ! cmp -s "$OUT/expected" "$OUT/replayed"; then
+		echo "ERROR: replaying $map reports"
+		diff "$OUT/expected" "$OUT/replayed"
+		exit 1
+	fi
+done
+
+"$DEADSTRIP" --from-map "$OUT/map.bin" --bmap "$OUT/again.bin" -o app.exe \
+	> /dev/null
+
+if ! cmp -s "$OUT/map.bin" "$OUT/again.bin"; then
+	echo "ERROR: the map written from a replayed one differs"
+	exit 1
+fi
+
+echo "map: ok"